@@ -0,0 +1,97 @@
+#include "utils/order_tree.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <random>
+#include <vector>
+
+constexpr std::size_t NODES = 10'000;
+constexpr std::size_t MOVES = 100'000;
+
+struct Node : utils::order_tree_node<Node> {
+    std::uint32_t value;
+};
+
+struct Move {
+    std::size_t from;
+    std::size_t to;
+};
+
+template <typename Fn> double measure(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<std::size_t> dist(0, NODES - 1);
+
+    std::vector<Move> moves(MOVES);
+    for (auto& move : moves) {
+        move.from = dist(rng);
+        move.to   = dist(rng);
+    }
+
+    // order tree
+    std::vector<Node> nodes(NODES);
+    utils::order_tree<Node> tree;
+
+    for (std::uint32_t i = 0; i < NODES; ++i) {
+        nodes[i].value = i;
+        tree.push_back(&nodes[i]);
+    }
+
+    double tree_ms = measure([&]() {
+        for (const auto& move : moves) {
+            Node* node = tree.at(move.from);
+            tree.erase(node);
+            tree.insert(move.to, node);
+
+            // position lookup, as done by the conflict markers
+            if (tree.index_of(node) != move.to) {
+                std::cerr << "Invalid position\n";
+                std::exit(1);
+            }
+        }
+    });
+
+    // linked list walk
+    std::list<std::uint32_t> list;
+    for (std::uint32_t i = 0; i < NODES; ++i) {
+        list.push_back(i);
+    }
+
+    double list_ms = measure([&]() {
+        for (const auto& move : moves) {
+            auto from  = std::next(list.begin(), static_cast<std::ptrdiff_t>(move.from));
+            auto value = *from;
+            list.erase(from);
+
+            auto to = std::next(list.begin(), static_cast<std::ptrdiff_t>(move.to));
+            list.insert(to, value);
+        }
+    });
+
+    // both sequences must match
+    auto it = list.begin();
+    for (std::size_t i = 0; i < NODES; ++i, ++it) {
+        if (tree.at(i)->value != *it) {
+            std::cerr << "Sequences differ at " << i << '\n';
+            return 1;
+        }
+    }
+
+    std::cout << "nodes: " << NODES << ", moves: " << MOVES << '\n';
+    std::cout << "order tree:  " << tree_ms << " ms\n";
+    std::cout << "linked list: " << list_ms << " ms\n";
+
+    return 0;
+}
@@ -60,7 +60,7 @@ class App : public QMainWindow {
      */
     bool openRepo(const std::string& path);
 
-    ~App() override { git_libgit2_shutdown(); }
+    ~App() override;
 
     /**
      * @brief Opens a repository and disables loading or opening other repositories.
@@ -83,14 +83,17 @@ class App : public QMainWindow {
     static void updateActions();
 
     /**
-     * @brief Updates the conflict list and markers.
+     * @brief Schedules an update of the conflict list, markers and commit graph.
      *
      * @param start The first action to update. If @c start is @c nullptr,
      *              the first action is used.
+     * @param converge The first action not affected by the change. If @c converge is
+     *                 @c nullptr, all actions after @c start are updated.
      *
-     * @details If @c start is @c nullptr, the update begins from the first action.
+     * @details If @c start is @c nullptr, the update begins from the first action. Updates of consecutive edits
+     * are merged and run once the edits stop.
      */
-    static void updateConflicts(action::Action* start = nullptr);
+    static void updateConflicts(action::Action* start = nullptr, action::Action* converge = nullptr);
 
     /**
      * @brief Returns the rebase view widget.
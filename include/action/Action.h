@@ -3,6 +3,7 @@
 #include "conflict/conflict.h"
 #include "git/types.h"
 #include "utils/optional_uint.h"
+#include "utils/order_tree.h"
 #include "utils/todo.h"
 
 #include <array>
@@ -63,7 +64,7 @@ static constexpr const char* type_to_str(ActionType type) {
 /**
  * @brief Represents a single rebase action.
  */
-class Action {
+class Action : public utils::order_tree_node<Action> {
 public:
     using ConflictStatus = conflict::ConflictStatus;
 
@@ -227,13 +228,6 @@ class Action {
      */
     [[nodiscard]] ActionType get_type() const { return m_type; }
 
-    /**
-     * @brief Sets action type.
-     *
-     * @param type New action type.
-     */
-    void set_type(ActionType type) { m_type = type; }
-
     /**
      * @brief Sets message ID.
      *
@@ -256,6 +250,9 @@ class Action {
 
     void set_prev(Action* prev) { m_prev = prev; }
 
+    // NOTE: Changed through the manager, so the plan version changes too
+    void set_type(ActionType type) { m_type = type; }
+
     void init_commit(git_repository* repo, const git_oid& oid) {
         const bool status = git_commit_lookup(&m_commit, repo, &oid) == 0;
         assert(status && m_commit != nullptr);
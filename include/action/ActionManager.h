@@ -1,10 +1,15 @@
 #pragma once
 
 #include "Action.h"
+#include "action/PlanSnapshot.h"
 #include "git/types.h"
+#include "utils/object_pool.h"
+#include "utils/order_tree.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -57,6 +62,8 @@ template <bool Contant> class ActionIterator {
 
 /**
  * @brief Manages a linked list of Actions and associated commit messages.
+ *
+ * @details The list is also indexed by an order statistic tree, so positional lookups and moves are logarithmic.
  */
 class ActionsManager {
 public:
@@ -171,7 +178,10 @@ class ActionsManager {
      *
      * @param commit Root commit.
      */
-    void set_root_commit(git_commit* commit) { m_root_commit = commit; }
+    void set_root_commit(git_commit* commit) {
+        m_root_commit = commit;
+        m_version += 1;
+    }
 
     /**
      * @brief Swaps commits of an action.
@@ -179,7 +189,45 @@ class ActionsManager {
      * @param act Target action.
      * @param commit Commit to swap.
      */
-    static void swap_commits(Action* act, git::commit_t& commit) { std::swap(act->m_commit, commit); }
+    void swap_commits(Action* act, git::commit_t& commit) {
+        std::swap(act->m_commit, commit);
+        changed(m_order.index_of(act));
+    }
+
+    /**
+     * @brief Changes type of an action.
+     *
+     * @param act Target action.
+     * @param type New action type.
+     */
+    void set_type(Action* act, ActionType type) {
+        act->set_type(type);
+        changed(m_order.index_of(act));
+    }
+
+    /**
+     * @brief Gets version of the plan, changed by every edit.
+     */
+    [[nodiscard]] std::uint64_t version() const { return m_version; }
+
+    /**
+     * @brief Gets an immutable copy of the plan.
+     *
+     * @details The copy is taken only when requested and shared until the plan or the resolutions change. The chunks
+     * before the first action changed since the previous copy are shared with it.
+     */
+    std::shared_ptr<const PlanSnapshot> snapshot();
+
+    /**
+     * @brief Checks whether a result computed from a snapshot still applies to the plan.
+     *
+     * @details The result applies if the plan did not change since the snapshot, or if the root commit, the
+     * resolutions and the actions the result depends on are the same.
+     *
+     * @param snapshot Snapshot the result was computed from.
+     * @param prefix Number of first actions the result depends on.
+     */
+    bool is_current(const PlanSnapshot& snapshot, std::size_t prefix);
 
     /**
      * @brief Gets global manager instance.
@@ -211,26 +259,49 @@ class ActionsManager {
      */
     std::uint32_t get_action_index(Action* find);
 
+    /**
+     * @brief Gets number of actions.
+     */
+    [[nodiscard]] std::size_t size() const { return m_order.size(); }
+
 private:
     Action* m_head = nullptr;
     Action* m_tail = nullptr;
 
+    utils::order_tree<Action> m_order;
+
+    // owns all actions
+    utils::object_pool<Action> m_pool;
+
     std::vector<std::string> m_msg;
 
     git_commit* m_root_commit = nullptr;
+
+    std::uint64_t m_version = 0;
+    std::shared_ptr<const PlanSnapshot> m_snapshot;
+
+    // the first action changed since the last snapshot
+    std::size_t m_changed_from = 0;
+
+    void changed(std::size_t index) {
+        m_changed_from = std::min(m_changed_from, index);
+        m_version += 1;
+    }
 };
 
 template <action_type Act> Action& ActionsManager::append(Act&& action) {
-    auto* ptr = new Action(std::forward<Act>(action));
+    auto* ptr = m_pool.create(std::forward<Act>(action));
 
     // tail <-> ptr
     ptr->set_prev_connection(m_tail);
+    m_order.push_back(ptr);
 
     if (m_head == nullptr) {
         m_head = ptr;
     }
     m_tail = ptr;
 
+    changed(m_order.size() - 1);
     return *ptr;
 }
 
@@ -5,6 +5,9 @@
 #include "conflict/ConflictManager.h"
 
 #include <ostream>
+#include <vector>
+
+#include <git2/oid.h>
 
 namespace action {
 
@@ -22,6 +25,7 @@ class Converter {
      * @param manager Actions manager containing actions to convert.
      * @param conflict_manager Conflict manager used during conversion.
      * @param insert_break Whether to insert a break command.
+     * @param commits Optional output for the commits referenced by the todo file.
      *
      * @return True if conversion succeeded, false otherwise.
      */
@@ -29,7 +33,8 @@ class Converter {
         std::ostream& output,
         ActionsManager& manager,
         conflict::ConflictManager& conflict_manager,
-        bool insert_break = false
+        bool insert_break = false,
+        std::vector<git_oid>* commits = nullptr
     );
 };
 
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "action/Action.h"
+#include "conflict/ConflictManager.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <git2/oid.h>
+
+namespace action {
+
+/**
+ * @brief Action stored in a plan snapshot.
+ */
+struct SnapshotAction {
+    git_oid commit;
+    ActionType type;
+
+    bool operator==(const SnapshotAction& other) const {
+        return type == other.type && git_oid_equal(&commit, &other.commit) != 0;
+    }
+};
+
+/**
+ * @brief Immutable copy of the plan.
+ *
+ * @details The snapshot holds only IDs, so a worker can read it while the plan is edited. The actions are stored in
+ * chunks, the chunks before the first edited action and the resolutions are shared with the other snapshots.
+ */
+class PlanSnapshot {
+public:
+    static constexpr std::size_t CHUNK_SIZE = 256;
+
+    using chunk_t = std::vector<SnapshotAction>;
+
+    PlanSnapshot(
+        std::uint64_t version,
+        const git_oid& root_commit,
+        std::vector<std::shared_ptr<const chunk_t>> chunks,
+        std::size_t size,
+        std::shared_ptr<const conflict::ResolutionsSnapshot> resolutions
+    )
+        : m_version(version)
+        , m_root_commit(root_commit)
+        , m_chunks(std::move(chunks))
+        , m_size(size)
+        , m_resolutions(std::move(resolutions)) { }
+
+    /**
+     * @brief Gets version of the plan the snapshot was taken from.
+     */
+    [[nodiscard]] std::uint64_t version() const { return m_version; }
+
+    /**
+     * @brief Gets root commit, zero if the plan has no root commit.
+     */
+    [[nodiscard]] const git_oid& root_commit() const { return m_root_commit; }
+
+    [[nodiscard]] const SnapshotAction& at(std::size_t index) const {
+        return (*m_chunks[index / CHUNK_SIZE])[index % CHUNK_SIZE];
+    }
+
+    [[nodiscard]] std::size_t size() const { return m_size; }
+
+    [[nodiscard]] const conflict::ResolutionsSnapshot& resolutions() const { return *m_resolutions; }
+
+private:
+    std::uint64_t m_version;
+    git_oid m_root_commit;
+
+    // all chunks except the last one are full
+    std::vector<std::shared_ptr<const chunk_t>> m_chunks;
+    std::size_t m_size;
+
+    std::shared_ptr<const conflict::ResolutionsSnapshot> m_resolutions;
+
+    // the unchanged parts are shared with the next snapshot
+    friend class ActionsManager;
+};
+
+}
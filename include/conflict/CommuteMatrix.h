@@ -0,0 +1,216 @@
+#pragma once
+
+#include "action/ActionManager.h"
+#include "git/TaskPool.h"
+#include "git/types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <git2/oid.h>
+#include <git2/types.h>
+
+namespace conflict {
+
+/**
+ * @brief Lines changed by a hunk.
+ *
+ * @details Zero-based half-open intervals before and after the change. Pure insertions and deletions are empty.
+ */
+struct LineRange {
+    int old_begin;
+    int old_end;
+    int new_begin;
+    int new_end;
+};
+
+/**
+ * @brief Lines of a file changed by a commit.
+ */
+struct TouchedFile {
+    std::string path;
+    // added, deleted and binary files conflict with every change
+    bool whole;
+    std::vector<LineRange> ranges;
+};
+
+/**
+ * @brief Files changed by a commit against its first parent.
+ */
+struct TouchedCommit {
+    git_oid commit;
+    git_oid parent;
+    bool has_parent;
+    std::vector<TouchedFile> files;
+};
+
+/**
+ * @brief Pairwise overlap of paths touched by the commits of the plan.
+ *
+ * @details Every commit is diffed once against its original parent. The touched paths are interned and stored as
+ * sorted arrays of path IDs, the hunks of every file are stored as line intervals. Commits that touch disjoint paths
+ * can be swapped without a conflict. Commits that touch the same file are compared by their line intervals, the
+ * intervals of the earlier commit are shifted through the commits between them in the original series. Both
+ * results of every pair are stored in bit matrices.
+ *
+ * The commits are diffed on a worker by collect(), the results are added on the UI thread by add().
+ */
+class CommuteMatrix {
+public:
+    /**
+     * @brief Gets the commits of the plan that are not in the matrix.
+     *
+     * @param actions Actions of the plan.
+     */
+    [[nodiscard]] std::vector<git_oid> missing(const action::ActionsManager& actions) const;
+
+    /**
+     * @brief Diffs the commits against their first parents.
+     *
+     * @details Runs on a worker of the task pool and does not touch the matrix. Idle workers help with a low priority
+     * batch, the number of diffed commits is reported through the token.
+     *
+     * @param repo Repository of the worker.
+     * @param commits Commits to diff.
+     * @param token Token of the task.
+     *
+     * @return Changed files of the commits or std::nullopt if a commit could not be diffed or the task was cancelled.
+     */
+    static std::optional<std::vector<TouchedCommit>>
+    collect(git_repository* repo, std::span<const git_oid> commits, git::TaskToken& token);
+
+    /**
+     * @brief Adds the collected commits to the matrix.
+     *
+     * @details Only the rows and columns of the new commits are computed. Known commits are skipped.
+     *
+     * @param commits Commits returned by collect().
+     */
+    void add(std::vector<TouchedCommit>&& commits);
+
+    /**
+     * @brief Gets index of a commit in the matrix.
+     *
+     * @param commit Commit ID.
+     *
+     * @return Index or std::nullopt if the commit is unknown.
+     */
+    [[nodiscard]] std::optional<std::size_t> index_of(const git_oid& commit) const;
+
+    /**
+     * @brief Checks whether two commits touch the same path.
+     *
+     * @param a Index of the first commit.
+     * @param b Index of the second commit.
+     */
+    [[nodiscard]] bool overlaps(std::size_t a, std::size_t b) const {
+        return (m_matrix[a * m_stride + b / WORD_BITS] & (std::uint64_t(1) << (b % WORD_BITS))) != 0;
+    }
+
+    /**
+     * @brief Checks whether two commits change the same or adjacent lines.
+     *
+     * @details The prediction is conservative, added, deleted and binary files changed by both commits always
+     * conflict.
+     *
+     * @param a Index of the first commit.
+     * @param b Index of the second commit.
+     */
+    [[nodiscard]] bool may_conflict(std::size_t a, std::size_t b) const {
+        return (m_conflicts[a * m_stride + b / WORD_BITS] & (std::uint64_t(1) << (b % WORD_BITS))) != 0;
+    }
+
+    /**
+     * @brief Checks whether two commits change the same or adjacent lines of a file.
+     *
+     * @param a Index of the first commit.
+     * @param b Index of the second commit.
+     * @param path Path of the file.
+     *
+     * @return False if the file is not touched by both commits.
+     */
+    [[nodiscard]] bool may_conflict(std::size_t a, std::size_t b, const std::string& path) const;
+
+    /**
+     * @brief Checks whether two commits can be swapped without a conflict.
+     *
+     * @details Unknown commits never commute.
+     *
+     * @param a First commit.
+     * @param b Second commit.
+     */
+    [[nodiscard]] bool can_commute(const git_oid& a, const git_oid& b) const;
+
+    /**
+     * @brief Gets IDs of paths touched by a commit.
+     *
+     * @param index Index of the commit.
+     */
+    [[nodiscard]] std::span<const std::uint32_t> paths(std::size_t index) const { return m_sets[index].files; }
+
+    /**
+     * @brief Gets number of commits in the matrix.
+     */
+    [[nodiscard]] std::size_t size() const { return m_sets.size(); }
+
+    /**
+     * @brief Forgets all commits and paths.
+     */
+    void clear();
+
+    /**
+     * @brief Gets global CommuteMatrix instance.
+     */
+    static CommuteMatrix& get() {
+        static CommuteMatrix matrix;
+        return matrix;
+    }
+
+private:
+    static constexpr std::size_t WORD_BITS = 64;
+
+    struct file_lines_t {
+        std::uint32_t path;
+        bool whole;
+        std::vector<LineRange> ranges;
+    };
+
+    struct path_set_t {
+        // sorted path IDs
+        std::vector<std::uint32_t> files;
+        // sorted IDs of the parent directories
+        std::vector<std::uint32_t> dirs;
+        // sorted by the path ID
+        std::vector<file_lines_t> lines;
+
+        // consecutive commits of the same series are parent and child
+        std::size_t series;
+        std::size_t position;
+    };
+
+    std::unordered_map<git_oid, std::size_t, git::oid_hash, git::oid_equal> m_index;
+    std::unordered_map<std::string, std::uint32_t> m_path_ids;
+    std::vector<path_set_t> m_sets;
+
+    // commits of every series touching the path, in the series order
+    std::unordered_map<std::uint32_t, std::vector<std::size_t>> m_touched_by;
+    std::size_t m_series = 0;
+
+    // row-major bit matrices, every row has m_stride words
+    std::vector<std::uint64_t> m_matrix;
+    std::vector<std::uint64_t> m_conflicts;
+    std::size_t m_stride = 0;
+
+    std::uint32_t intern(const std::string& path);
+    void extend_matrix(std::size_t first);
+
+    [[nodiscard]] bool lines_conflict(std::size_t a, std::size_t b) const;
+    [[nodiscard]] bool file_conflicts(std::size_t a, std::size_t b, std::uint32_t path) const;
+};
+
+}
@@ -2,32 +2,42 @@
 
 #include "conflict/conflict_iterator.h"
 #include "git/types.h"
+#include "utils/flat_map.h"
 
-#include <map>
+#include <cstddef>
+#include <memory>
 #include <span>
 #include <string>
 
 #include <git2/index.h>
+#include <git2/oid.h>
 #include <git2/types.h>
 
 namespace conflict {
 
 /**
  * @brief Represents a file-level conflict entry.
+ *
+ * @details Missing sides have a zero ID.
  */
 struct ConflictEntry {
-    std::string ancestor_id;
-    std::string their_id;
-    std::string our_id;
-
-    bool operator<(const ConflictEntry& other) const {
-        if (ancestor_id != other.ancestor_id) {
-            return ancestor_id < other.ancestor_id;
-        }
-        if (their_id != other.their_id) {
-            return their_id < other.their_id;
-        }
-        return our_id < other.our_id;
+    git_oid ancestor_id {};
+    git_oid their_id {};
+    git_oid our_id {};
+
+    bool operator==(const ConflictEntry& other) const {
+        return git_oid_equal(&ancestor_id, &other.ancestor_id) != 0 && git_oid_equal(&their_id, &other.their_id) != 0
+            && git_oid_equal(&our_id, &other.our_id) != 0;
+    }
+};
+
+/**
+ * @brief Hash of the conflict entry.
+ */
+struct ConflictEntryHash {
+    std::size_t operator()(const ConflictEntry& entry) const {
+        git::oid_hash hash;
+        return hash(entry.ancestor_id) ^ (hash(entry.their_id) * 31) ^ (hash(entry.our_id) * 131);
     }
 };
 
@@ -35,18 +45,38 @@ struct ConflictEntry {
  * @brief Represents a tree-level conflict between commits.
  */
 struct ConflictTrees {
-    std::string parent_tree_id;
-    std::string commit_id;
+    git_oid parent_tree_id {};
+    git_oid commit_id {};
 
-    bool operator<(const ConflictTrees& other) const {
-        if (parent_tree_id != other.parent_tree_id) {
-            return parent_tree_id < other.parent_tree_id;
-        }
+    bool operator==(const ConflictTrees& other) const {
+        return git_oid_equal(&parent_tree_id, &other.parent_tree_id) != 0
+            && git_oid_equal(&commit_id, &other.commit_id) != 0;
+    }
+};
 
-        return commit_id < other.commit_id;
+/**
+ * @brief Hash of the tree-level conflict.
+ */
+struct ConflictTreesHash {
+    std::size_t operator()(const ConflictTrees& conflict) const {
+        git::oid_hash hash;
+        return hash(conflict.parent_tree_id) ^ (hash(conflict.commit_id) * 31);
     }
 };
 
+// resolved blobs, zero if the file is deleted
+using resolutions_t = utils::flat_map<ConflictEntry, git_oid, ConflictEntryHash>;
+
+/**
+ * @brief Immutable copy of the stored resolutions.
+ *
+ * @details Trees are stored by their IDs, so the copy can be read by any thread.
+ */
+struct ResolutionsSnapshot {
+    resolutions_t conflicts;
+    utils::flat_map<ConflictTrees, git_oid, ConflictTreesHash> trees;
+};
+
 /**
  * @brief Manages conflict resolution for Git operations.
  */
@@ -75,6 +105,8 @@ class ConflictManager {
     /**
      * @brief Checks whether a conflict entry is resolved.
      *
+     * @details A resolution stored in the DiskCache is reused.
+     *
      * @param entry Conflict entry.
      *
      * @return True if resolved, false otherwise.
@@ -134,13 +166,34 @@ class ConflictManager {
      */
     bool apply_resolution(const std::string& path, const ConflictEntry& entry, git_repository* repo, git_index* index);
 
+    /**
+     * @brief Applies a single conflict resolution from the given resolutions.
+     *
+     * @details Only the arguments are used, so a worker can apply the resolutions of a snapshot.
+     *
+     * @param resolutions Stored resolutions.
+     * @param path File path.
+     * @param entry Conflict entry.
+     * @param repo Git repository.
+     * @param index Git index.
+     *
+     * @return True if resolution succeeded.
+     */
+    static bool apply_resolution(
+        const resolutions_t& resolutions,
+        const std::string& path,
+        const ConflictEntry& entry,
+        git_repository* repo,
+        git_index* index
+    );
+
     /**
      * @brief Stores a resolved conflict entry.
      *
      * @param entry Conflict entry.
-     * @param id Resolution identifier.
+     * @param id Resolved blob, zero if the file is deleted.
      */
-    void add_resolution(const ConflictEntry& entry, std::string id);
+    void add_resolution(const ConflictEntry& entry, const git_oid& id);
 
     /**
      * @brief Stores a resolved tree conflict.
@@ -173,7 +226,17 @@ class ConflictManager {
     /**
      * @brief Clears all stored conflicts.
      */
-    void clear() { m_conflicts.clear(); }
+    void clear() {
+        m_conflicts.clear();
+        m_snapshot = nullptr;
+    }
+
+    /**
+     * @brief Gets a copy of the stored resolutions.
+     *
+     * @details The copy is shared until a resolution is added.
+     */
+    std::shared_ptr<const ResolutionsSnapshot> snapshot();
 
     /**
      * @brief Gets global ConflictManager instance.
@@ -184,9 +247,12 @@ class ConflictManager {
     }
 
 private:
-    std::map<ConflictEntry, std::string> m_conflicts;
+    resolutions_t m_conflicts;
+
+    utils::flat_map<ConflictTrees, git::tree_t, ConflictTreesHash> m_trees;
 
-    std::map<ConflictTrees, git::tree_t> m_trees;
+    // dropped by every change
+    std::shared_ptr<const ResolutionsSnapshot> m_snapshot;
 };
 
 }
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "conflict/ConflictManager.h"
+#include "conflict/MergeCache.h"
+#include "git/types.h"
+#include "utils/flat_map.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <vector>
+
+#include <git2/oid.h>
+#include <git2/types.h>
+
+namespace conflict {
+
+/**
+ * @brief Merge results and conflict resolutions kept across sessions.
+ *
+ * @details The records are appended to a file in the Git directory of the repository. Every record is keyed by
+ * object IDs only, so a record stays valid as long as the object it points to exists. The objects are checked on
+ * lookup and written to the repository when the cache is closed. The file is compacted once it holds too many
+ * outdated records. Used only by the UI thread.
+ */
+class DiskCache {
+public:
+    // limit of the records kept by the compaction
+    static constexpr std::size_t MAX_RECORDS = 1 << 18;
+
+    /**
+     * @brief Loads the cache of the repository.
+     *
+     * @param repo Git repository.
+     *
+     * @return True if successful.
+     */
+    bool open(git_repository* repo);
+
+    /**
+     * @brief Writes the new records and the objects they point to, the file is compacted if needed.
+     */
+    void close();
+
+    /**
+     * @brief Checks whether the cache is open.
+     */
+    [[nodiscard]] bool is_open() const { return m_odb.get() != nullptr; }
+
+    /**
+     * @brief Looks up a merge result.
+     *
+     * @param key Replay step.
+     *
+     * @return Result or std::nullopt if the result is missing or its tree no longer exists.
+     */
+    std::optional<MergeResult> find_merge(const MergeKey& key);
+
+    /**
+     * @brief Stores a merge result.
+     *
+     * @details Only results with or without a conflict are stored.
+     */
+    void insert_merge(const MergeKey& key, const MergeResult& result);
+
+    /**
+     * @brief Looks up a conflict resolution.
+     *
+     * @param entry Conflict entry.
+     *
+     * @return Resolved blob (zero if the file is deleted) or std::nullopt if the resolution is missing or its blob
+     * no longer exists.
+     */
+    std::optional<git_oid> find_resolution(const ConflictEntry& entry);
+
+    /**
+     * @brief Stores a conflict resolution.
+     *
+     * @param entry Conflict entry.
+     * @param blob Resolved blob, zero if the file is deleted.
+     */
+    void insert_resolution(const ConflictEntry& entry, const git_oid& blob);
+
+    /**
+     * @brief Gets global DiskCache instance.
+     */
+    static DiskCache& get() {
+        static DiskCache cache;
+        return cache;
+    }
+
+private:
+    enum class record_kind_t : std::uint8_t {
+        MERGE      = 1,
+        RESOLUTION = 2,
+    };
+
+    // merge: parent tree, commit, result tree; resolution: ancestor, their, our, blob
+    struct record_t {
+        record_kind_t kind;
+        std::uint8_t type;
+        std::uint8_t status;
+        std::uint8_t reserved;
+        git_oid ids[4];
+    };
+
+    struct header_t {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t record_size;
+    };
+
+    static constexpr std::uint32_t VERSION = 1;
+
+    // the record is outdated or its object is missing
+    static constexpr std::uint32_t INVALID = UINT32_MAX;
+
+    std::filesystem::path m_path;
+    std::ofstream m_out;
+    git::odb_t m_odb;
+
+    // the records of the file followed by the new records
+    std::vector<record_t> m_records;
+    std::size_t m_stored = 0;
+    std::size_t m_stale  = 0;
+    bool m_rewrite       = false;
+
+    // the latest record of a key
+    utils::flat_map<MergeKey, std::uint32_t, MergeKeyHash> m_merges;
+    utils::flat_map<ConflictEntry, std::uint32_t, ConflictEntryHash> m_resolutions;
+
+    // position of the latest record with the same key
+    std::uint32_t* find_position(const record_t& record);
+
+    void index(std::uint32_t position);
+
+    void append(const record_t& record);
+
+    bool exists(const git_oid& oid);
+
+    void load();
+
+    // keeps only the latest valid records
+    bool compact();
+
+    void reset();
+};
+
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "action/Action.h"
+#include "conflict/conflict.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <unordered_map>
+
+#include <git2/oid.h>
+#include <git2/types.h>
+
+namespace conflict {
+
+/**
+ * @brief Identifies a single replay step.
+ */
+struct MergeKey {
+    git_oid parent_tree;
+    git_oid commit;
+    action::ActionType type;
+
+    bool operator==(const MergeKey& other) const {
+        return type == other.type && git_oid_equal(&parent_tree, &other.parent_tree) != 0
+            && git_oid_equal(&commit, &other.commit) != 0;
+    }
+};
+
+/**
+ * @brief Hash of the merge key.
+ */
+struct MergeKeyHash {
+    std::size_t operator()(const MergeKey& key) const {
+        // OIDs are already uniformly distributed, the prefix is enough
+        std::size_t parent;
+        std::size_t commit;
+        std::memcpy(&parent, key.parent_tree.id, sizeof(parent));
+        std::memcpy(&commit, key.commit.id, sizeof(commit));
+
+        return parent ^ (commit * 31) ^ static_cast<std::size_t>(key.type);
+    }
+};
+
+/**
+ * @brief Result of a replay step.
+ */
+struct MergeResult {
+    git_oid tree;
+    ConflictStatus status;
+};
+
+/**
+ * @brief Memoizes merge results of the conflict replay.
+ *
+ * @details Only raw merge results are stored. Results with applied conflict resolutions depend on the
+ * ConflictManager state and are never cached. Missing results are looked up in the DiskCache, new results are
+ * written to it.
+ */
+class MergeCache {
+public:
+    /**
+     * @brief Looks up a merge result.
+     *
+     * @param parent_tree Tree the commit is applied onto.
+     * @param commit Applied commit.
+     * @param type Action type.
+     *
+     * @return Cached result or std::nullopt.
+     */
+    std::optional<MergeResult> find(const git_oid& parent_tree, const git_oid& commit, action::ActionType type);
+
+    /**
+     * @brief Stores a merge result.
+     *
+     * @param parent_tree Tree the commit is applied onto.
+     * @param commit Applied commit.
+     * @param type Action type.
+     * @param result Merge result.
+     */
+    void insert(const git_oid& parent_tree, const git_oid& commit, action::ActionType type, const MergeResult& result);
+
+    /**
+     * @brief Gets number of successful lookups.
+     */
+    [[nodiscard]] std::uint64_t hits() const { return m_hits; }
+
+    /**
+     * @brief Gets number of failed lookups.
+     */
+    [[nodiscard]] std::uint64_t misses() const { return m_misses; }
+
+    /**
+     * @brief Gets number of cached results.
+     */
+    [[nodiscard]] std::size_t size() const { return m_results.size(); }
+
+    /**
+     * @brief Removes all results and resets the counters.
+     */
+    void clear();
+
+    /**
+     * @brief Gets global MergeCache instance.
+     */
+    static MergeCache& get() {
+        static MergeCache cache;
+        return cache;
+    }
+
+private:
+    std::unordered_map<MergeKey, MergeResult, MergeKeyHash> m_results;
+
+    std::uint64_t m_hits   = 0;
+    std::uint64_t m_misses = 0;
+};
+
+}
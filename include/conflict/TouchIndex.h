@@ -0,0 +1,86 @@
+#pragma once
+
+#include "action/Action.h"
+#include "git/DiffCache.h"
+#include "git/types.h"
+#include "utils/flat_map.h"
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+#include <git2/oid.h>
+#include <git2/types.h>
+
+namespace conflict {
+
+/**
+ * @brief Index of the actions that produced every blob of the plan.
+ *
+ * @details Every action tree is diffed once against the tree of the previous action, with rename detection. A
+ * produced blob points to the blob it replaced, so the history of a file (including renames) is followed by
+ * lookups only. Diffs are kept per tree pair, an edit of the plan diffs only the changed pairs. Used only by the
+ * UI thread.
+ */
+class TouchIndex {
+public:
+    /**
+     * @brief Iterates over the actions that produced the files, from the conflicting action backwards.
+     *
+     * @param conflict_action Conflicting action, the files are blobs of its commit.
+     * @param repo Git repository.
+     * @param files Blob IDs.
+     * @param callback Callback receiving the index of a touching action, returns true to stop.
+     *
+     * @return True if successful.
+     */
+    bool iterate(
+        action::Action& conflict_action,
+        git_repository* repo,
+        std::span<const git_oid> files,
+        const std::function<bool(std::uint32_t)>& callback
+    );
+
+    /**
+     * @brief Removes the index and the stored diffs.
+     */
+    void clear();
+
+    /**
+     * @brief Gets global TouchIndex instance.
+     */
+    static TouchIndex& get() {
+        static TouchIndex index;
+        return index;
+    }
+
+private:
+    // a blob produced by a tree pair, zero if the file was added
+    struct change_t {
+        git_oid old_blob;
+        git_oid new_blob;
+    };
+
+    // the action produced the blob from the old blob
+    struct touch_t {
+        std::uint32_t action;
+        git_oid old_blob;
+    };
+
+    using changes_t = utils::flat_map<git::DiffKey, std::vector<change_t>, git::DiffKeyHash>;
+
+    changes_t m_changes;
+
+    // trees the index was built from, the root tree first
+    std::vector<git_oid> m_trees;
+
+    // actions sorted by the index
+    utils::flat_map<git_oid, std::vector<touch_t>, git::oid_hash, git::oid_equal> m_touches;
+
+    bool update(std::span<git_tree* const> trees, git_repository* repo);
+
+    static bool diff_trees(git_tree* old_tree, git_tree* new_tree, git_repository* repo, std::vector<change_t>& out);
+};
+
+}
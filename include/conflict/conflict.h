@@ -3,8 +3,7 @@
 #include "conflict/ConflictManager.h"
 #include "git/types.h"
 
-#include <cstdint>
-#include <functional>
+#include <atomic>
 #include <optional>
 #include <span>
 #include <string>
@@ -15,6 +14,7 @@
 
 namespace action {
 class Action;
+enum class ActionType;
 
 }
 
@@ -88,6 +88,56 @@ std::pair<ConflictStatus, git::index_t> cherrypick_check(action::Action* act, gi
  */
 std::pair<ConflictStatus, git::index_t> cherrypick_check(action::Action* act, action::Action* parent_act);
 
+/**
+ * @brief Applies an action onto a tree without building a merge index.
+ *
+ * @details Only the entries changed by the action and between its original parent and the tree are compared. Entries
+ * changed on one side are taken from that side, files modified on both sides are merged line by line. The result is
+ * written into the tree directly, only the directories on the changed paths are rewritten.
+ *
+ * @param act Action to apply, must not be a drop.
+ * @param parent_tree Tree the action is applied onto.
+ *
+ * @return Resulting tree or std::nullopt if the action conflicts or needs the full merge (added, deleted or renamed
+ * files changed on both sides).
+ */
+std::optional<git_oid> apply_sparse(action::Action* act, git_tree* parent_tree);
+
+/**
+ * @brief Single commit of a replay.
+ */
+struct ReplayStep {
+    git_oid commit;
+    action::ActionType type;
+
+    // filled in by the replay
+    git_oid tree;
+    ConflictStatus status = ConflictStatus::UNKNOWN;
+};
+
+/**
+ * @brief Replays commits onto a tree with the full merge.
+ *
+ * @details Only the objects of the repository are used, so the replay can run on a worker thread with the worker
+ * repository. Conflicts with a recorded resolution for every file are resolved. The replay stops at the first
+ * unresolved conflict, the following steps stay unknown.
+ *
+ * @param repo Git repository.
+ * @param tree Tree the first commit is applied onto.
+ * @param steps Commits to apply.
+ * @param resolutions Recorded resolutions, usually from a snapshot.
+ * @param cancel Flag checked before every merge.
+ *
+ * @return False if the replay failed or was cancelled.
+ */
+bool replay_detached(
+    git_repository* repo,
+    const git_oid& tree,
+    std::span<ReplayStep> steps,
+    const resolutions_t& resolutions,
+    const std::atomic_bool& cancel
+);
+
 /**
  * @brief Applies resolved files to the index.
  *
@@ -107,23 +157,4 @@ ResolutionResult add_resolved_files(
     ConflictManager& manager
 );
 
-/**
- * @brief Iterates over conflict action and execute callback per item.
- *
- * @param conflict_action Conflict action.
- * @param repo Git repository.
- * @param files List of file OIDs.
- * @param callback Callback invoked per iteration.
- * @param payload User data passed to callback.
- *
- * @return True if iteration completed successfully.
- */
-bool iterate_actions(
-    action::Action& conflict_action,
-    git_repository* repo,
-    std::span<const git_oid> files,
-    std::function<bool(bool, std::uint32_t, void*)> callback,
-    void* payload
-);
-
 }
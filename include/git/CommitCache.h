@@ -0,0 +1,72 @@
+#pragma once
+
+#include "git/types.h"
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+
+#include <git2/oid.h>
+#include <git2/types.h>
+
+namespace git {
+
+/**
+ * @brief Least recently used cache of parsed commits.
+ *
+ * @details The commit graph stores only commit IDs, the commits are parsed once a node is painted, selected or
+ * diffed. A returned commit stays valid until the cache evicts it, a caller that keeps the commit must duplicate
+ * it (git_commit_dup). Used only by the UI thread.
+ */
+class CommitCache {
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 1024;
+
+    /**
+     * @brief Sets the repository the commits are loaded from and removes all commits.
+     *
+     * @param repo Git repository.
+     */
+    void attach(git_repository* repo);
+
+    /**
+     * @brief Gets a commit and marks it as the most recently used.
+     *
+     * @param oid Commit ID.
+     *
+     * @return Commit or nullptr if the commit can not be loaded.
+     */
+    git_commit* find(const git_oid& oid);
+
+    /**
+     * @brief Gets number of cached commits.
+     */
+    [[nodiscard]] std::size_t size() const { return m_entries.size(); }
+
+    /**
+     * @brief Removes all commits.
+     */
+    void clear();
+
+    /**
+     * @brief Gets global CommitCache instance.
+     */
+    static CommitCache& get() {
+        static CommitCache cache;
+        return cache;
+    }
+
+private:
+    struct entry_t {
+        git_oid id;
+        commit_t commit;
+    };
+
+    git_repository* m_repo = nullptr;
+
+    // most recently used first
+    std::list<entry_t> m_entries;
+    std::unordered_map<git_oid, std::list<entry_t>::iterator, oid_hash, oid_equal> m_index;
+};
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <git2/oid.h>
+#include <git2/types.h>
+
+namespace git {
+
+/**
+ * @brief Commit metadata stored in the commit-graph file.
+ */
+struct CommitGraphEntry {
+    // two means two or more parents
+    std::uint32_t parent_count;
+};
+
+/**
+ * @brief Reader of the commit-graph file of a repository.
+ *
+ * @details The file (objects/info/commit-graph) stores the parents of the commits, so merge commits are known
+ * without parsing the commit objects. Only a single file is supported, split commit-graph chains are ignored. Commits
+ * written after the file was generated are missing.
+ */
+class CommitGraph {
+public:
+    /**
+     * @brief Loads the commit-graph file of the repository.
+     *
+     * @param repo Git repository.
+     *
+     * @return CommitGraph or std::nullopt if the file is missing or invalid.
+     */
+    static std::optional<CommitGraph> open(git_repository* repo);
+
+    /**
+     * @brief Looks up a commit.
+     *
+     * @param oid Commit ID.
+     *
+     * @return Entry or std::nullopt if the commit is not in the file.
+     */
+    [[nodiscard]] std::optional<CommitGraphEntry> find(const git_oid& oid) const;
+
+    /**
+     * @brief Gets number of commits in the file.
+     */
+    [[nodiscard]] std::size_t size() const { return m_count; }
+
+private:
+    std::vector<unsigned char> m_data;
+    std::size_t m_count = 0;
+
+    // offsets of the chunks
+    std::size_t m_fanout  = 0;
+    std::size_t m_oids    = 0;
+    std::size_t m_commits = 0;
+
+    CommitGraph() = default;
+};
+
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include "git/diff.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+
+#include <git2/diff.h>
+#include <git2/oid.h>
+#include <git2/types.h>
+
+namespace git {
+
+/**
+ * @brief Identifies a diff between two trees.
+ *
+ * @details Every option that changes the diff has its own field, zero fields are the default options.
+ */
+struct DiffKey {
+    git_oid old_tree {};
+    git_oid new_tree {};
+
+    // git_diff_options
+    std::uint32_t flags           = 0;
+    std::uint32_t context_lines   = 0;
+    std::uint32_t interhunk_lines = 0;
+
+    // git_diff_find_options, the defaults of libgit2 are used without them
+    bool has_find_opts                          = false;
+    std::uint32_t find_flags                    = 0;
+    std::uint16_t rename_threshold              = 0;
+    std::uint16_t rename_from_rewrite_threshold = 0;
+    std::uint16_t copy_threshold                = 0;
+    std::uint16_t break_rewrite_threshold       = 0;
+    std::size_t rename_limit                    = 0;
+
+    bool operator==(const DiffKey& other) const {
+        return flags == other.flags && context_lines == other.context_lines
+            && interhunk_lines == other.interhunk_lines && has_find_opts == other.has_find_opts
+            && find_flags == other.find_flags && rename_threshold == other.rename_threshold
+            && rename_from_rewrite_threshold == other.rename_from_rewrite_threshold
+            && copy_threshold == other.copy_threshold && break_rewrite_threshold == other.break_rewrite_threshold
+            && rename_limit == other.rename_limit && git_oid_equal(&old_tree, &other.old_tree) != 0
+            && git_oid_equal(&new_tree, &other.new_tree) != 0;
+    }
+};
+
+/**
+ * @brief Hash of the diff key.
+ */
+struct DiffKeyHash {
+    std::size_t operator()(const DiffKey& key) const {
+        // OIDs are already uniformly distributed, the prefix is enough
+        std::size_t old_tree;
+        std::size_t new_tree;
+        std::memcpy(&old_tree, key.old_tree.id, sizeof(old_tree));
+        std::memcpy(&new_tree, key.new_tree.id, sizeof(new_tree));
+
+        std::size_t hash = old_tree ^ (new_tree * 31);
+
+        // NOTE: The options are mostly the defaults, they only separate the rare variants
+        for (std::size_t value : {
+                 static_cast<std::size_t>(key.flags),
+                 static_cast<std::size_t>(key.context_lines),
+                 static_cast<std::size_t>(key.interhunk_lines),
+                 static_cast<std::size_t>(key.has_find_opts),
+                 static_cast<std::size_t>(key.find_flags),
+                 static_cast<std::size_t>(key.rename_threshold),
+                 static_cast<std::size_t>(key.rename_from_rewrite_threshold),
+                 static_cast<std::size_t>(key.copy_threshold),
+                 static_cast<std::size_t>(key.break_rewrite_threshold),
+                 key.rename_limit,
+             }) {
+            hash = (hash * 31) + value;
+        }
+
+        return hash;
+    }
+};
+
+/**
+ * @brief Least recently used cache of parsed tree diffs.
+ *
+ * @details Diffs are shared with the views that display them, a diff evicted from the cache stays alive until the
+ * last view releases it. The memory usage is estimated from the paths, hunks and generated patches and is
+ * updated every time a diff is looked up, because hunks are generated lazily.
+ */
+class DiffCache {
+public:
+    static constexpr std::size_t DEFAULT_BUDGET = static_cast<std::size_t>(64) * 1024 * 1024;
+
+    /**
+     * @brief Creates the key of a diff between two trees.
+     *
+     * @param old_tree Old tree or nullptr.
+     * @param new_tree New tree or nullptr.
+     * @param opts Diff options or nullptr.
+     * @param find_opts Rename detection options or nullptr.
+     *
+     * @return Key or std::nullopt if the diff can not be cached.
+     */
+    static std::optional<DiffKey> key_for(
+        git_tree* old_tree,
+        git_tree* new_tree,
+        const git_diff_options* opts = nullptr,
+        const git_diff_find_options* find_opts = nullptr
+    );
+
+    /**
+     * @brief Looks up a diff and marks it as the most recently used.
+     *
+     * @param key Diff key.
+     *
+     * @return Cached diff or nullptr.
+     */
+    std::shared_ptr<diff_model_t> find(const DiffKey& key);
+
+    /**
+     * @brief Stores a diff and evicts the least recently used diffs over the budget.
+     *
+     * @param key Diff key.
+     * @param model Parsed diff.
+     */
+    void insert(const DiffKey& key, std::shared_ptr<diff_model_t> model);
+
+    /**
+     * @brief Sets the memory budget in bytes.
+     */
+    void set_budget(std::size_t budget);
+
+    /**
+     * @brief Gets estimated memory usage in bytes.
+     */
+    [[nodiscard]] std::size_t memory() const { return m_memory; }
+
+    /**
+     * @brief Gets number of successful lookups.
+     */
+    [[nodiscard]] std::uint64_t hits() const { return m_hits; }
+
+    /**
+     * @brief Gets number of failed lookups.
+     */
+    [[nodiscard]] std::uint64_t misses() const { return m_misses; }
+
+    /**
+     * @brief Gets number of cached diffs.
+     */
+    [[nodiscard]] std::size_t size() const { return m_entries.size(); }
+
+    /**
+     * @brief Removes all diffs and resets the counters.
+     */
+    void clear();
+
+    /**
+     * @brief Gets global DiffCache instance.
+     */
+    static DiffCache& get() {
+        static DiffCache cache;
+        return cache;
+    }
+
+private:
+    struct entry_t {
+        DiffKey key;
+        std::shared_ptr<diff_model_t> model;
+        std::size_t memory;
+    };
+
+    // most recently used first
+    std::list<entry_t> m_entries;
+    std::unordered_map<DiffKey, std::list<entry_t>::iterator, DiffKeyHash> m_index;
+
+    std::size_t m_budget = DEFAULT_BUDGET;
+    std::size_t m_memory = 0;
+
+    std::uint64_t m_hits   = 0;
+    std::uint64_t m_misses = 0;
+
+    void evict();
+};
+
+}
@@ -1,14 +1,14 @@
 #pragma once
 
+#include "CommitGraph.h"
 #include "types.h"
+#include "utils/flat_map.h"
 
 #include <cassert>
 #include <cstdint>
 #include <functional>
 #include <optional>
 #include <span>
-#include <string>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -22,14 +22,26 @@ namespace git {
 /**
  * @brief Node inside a Git graph.
  *
+ * @details Only the commit ID is stored, the commit is loaded when it is needed (see CommitCache).
+ *
  * @tparam Data User-defined payload stored per node.
  */
 template <typename Data> struct GitNode {
-    commit_t commit;
+    git_oid id;
     std::uint32_t depth;
     Data data;
 };
 
+/**
+ * @brief Sources of the commit parents used to build a graph.
+ */
+struct GitGraphStats {
+    // answered by the commit-graph file
+    std::uint32_t commit_graph = 0;
+    // parsed from the object database
+    std::uint32_t odb = 0;
+};
+
 /**
  * @brief Represents a Git commit graph between two commits.
  *
@@ -88,29 +100,52 @@ class GitGraph {
             return std::nullopt;
         }
 
+        // NOTE: Merge commits are skipped without parsing them if the commit-graph file knows them
+        auto commit_graph = CommitGraph::open(repo);
+
         git_oid oid;
         std::uint32_t idx = 0;
 
         // [start_commit..end_commit)
         while (git_revwalk_next(&oid, walker) == 0) {
-            commit_t commit;
+            std::optional<CommitGraphEntry> entry;
+            if (commit_graph.has_value()) {
+                entry = commit_graph->find(oid);
+            }
+
+            if (entry.has_value()) {
+                graph.m_stats.commit_graph += 1;
 
-            if (git_commit_lookup(&commit, repo, &oid) != 0) {
-                git_revwalk_free(walker);
-                return std::nullopt;
+                // skip merge commits
+                if (entry->parent_count > 1) {
+                    continue;
+                }
+            } else {
+                graph.m_stats.odb += 1;
             }
 
-            // skip merge commits
-            if (git_commit_parentcount(commit) > 1) {
-                continue;
+            // the commit is parsed only if the file does not know it
+            if (!entry.has_value()) {
+                commit_t commit;
+
+                if (git_commit_lookup(&commit, repo, &oid) != 0) {
+                    git_revwalk_free(walker);
+                    return std::nullopt;
+                }
+
+                // skip merge commits
+                if (git_commit_parentcount(commit) > 1) {
+                    continue;
+                }
             }
 
-            graph.try_insert(std::move(commit), idx);
+            graph.try_insert(oid, idx);
             idx += 1;
         }
 
         // insert oldest commit
-        graph.try_insert(std::move(end_commit), idx);
+        graph.try_insert(*git_commit_id(end_commit), idx);
+        graph.m_root = std::move(end_commit);
 
         git_revwalk_free(walker);
         return graph;
@@ -121,7 +156,17 @@ class GitGraph {
      *
      * @param id Commit ID.
      */
-    bool contains(const std::string& id) const { return m_commit_map.contains(id); }
+    bool contains(const git_oid& id) const { return m_commit_map.contains(id); }
+
+    /**
+     * @brief Gets sources of the commit parents used to build the graph.
+     */
+    const GitGraphStats& stats() const { return m_stats; }
+
+    /**
+     * @brief Gets commit of the oldest node.
+     */
+    git_commit* root_commit() { return m_root; }
 
     /**
      * @brief Gets the first node in traversal order.
@@ -147,9 +192,9 @@ class GitGraph {
      *
      * @param id Commit ID.
      */
-    node_t& get(const std::string& id) { return m_nodes[get_index(id)]; }
+    node_t& get(const git_oid& id) { return m_nodes[get_index(id)]; }
 
-    const node_t& get(const std::string& id) const { return m_nodes[get_index(id)]; }
+    const node_t& get(const git_oid& id) const { return m_nodes[get_index(id)]; }
 
     /**
      * @brief Gets node by index.
@@ -165,9 +210,9 @@ class GitGraph {
      *
      * @param id Commit ID.
      */
-    std::uint32_t get_index(const std::string& id) const {
+    std::uint32_t get_index(const git_oid& id) const {
         assert(contains(id));
-        return m_commit_map.at(id);
+        return *m_commit_map.find(id);
     }
 
     /**
@@ -209,28 +254,28 @@ class GitGraph {
     }
 
 private:
-    std::unordered_map<std::string, std::uint32_t> m_commit_map;
+    utils::flat_map<git_oid, std::uint32_t, oid_hash, oid_equal> m_commit_map;
     std::vector<node_t> m_nodes;
+    GitGraphStats m_stats;
 
-    GitGraph() = default;
-
-    static std::string commit_id(const git_commit* commit) { return format_oid_to_str(git_commit_id(commit)); }
+    // the only parsed commit, used as the root of the plan
+    commit_t m_root;
 
-    std::uint32_t try_insert(commit_t&& commit, std::uint32_t depth) {
+    GitGraph() = default;
 
-        auto id = commit_id(commit);
-        if (contains(id)) {
-            return get_index(id);
+    std::uint32_t try_insert(const git_oid& id, std::uint32_t depth) {
+        if (const std::uint32_t* found = m_commit_map.find(id); found != nullptr) {
+            return *found;
         }
 
         std::uint32_t index = m_nodes.size();
-        m_commit_map.emplace(id, index);
+        m_commit_map.insert_or_assign(id, index);
 
         m_nodes.push_back(
             node_t {
-                .commit = std::move(commit),
-                .depth  = depth,
-                .data   = {},
+                .id    = id,
+                .depth = depth,
+                .data  = {},
             }
         );
 
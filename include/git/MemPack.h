@@ -0,0 +1,69 @@
+#pragma once
+
+#include "git/types.h"
+
+#include <span>
+#include <unordered_set>
+
+#include <git2/oid.h>
+#include <git2/sys/odb_backend.h>
+#include <git2/types.h>
+
+namespace git {
+
+/**
+ * @brief In-memory object database layered over a repository.
+ *
+ * @details Every object written during the session (merge results, split commits, resolution commits, ...) is
+ * kept in memory instead of being written as a loose object. Objects are written to the repository only when
+ * they are flushed, as a single packfile. Access to the backend is serialized, so the object database can be
+ * shared with worker threads.
+ */
+class MemPack {
+public:
+    /**
+     * @brief Layers a new in-memory backend over the repository object database.
+     *
+     * @param repo Git repository.
+     *
+     * @return True if successful.
+     */
+    bool attach(git_repository* repo);
+
+    /**
+     * @brief Writes objects reachable from the roots to the repository.
+     *
+     * @param roots Commits, trees or blobs that must be persisted.
+     *
+     * @details Only objects that exist solely in memory are written. Objects that are already in the repository
+     * are not traversed.
+     *
+     * @return True if successful.
+     */
+    bool flush(std::span<const git_oid> roots);
+
+    /**
+     * @brief Checks whether the backend is attached.
+     */
+    [[nodiscard]] bool is_attached() const { return m_backend != nullptr; }
+
+    /**
+     * @brief Gets global MemPack instance.
+     */
+    static MemPack& get() {
+        static MemPack mempack;
+        return mempack;
+    }
+
+private:
+    git_repository* m_repo = nullptr;
+
+    // owned by the repository object database
+    git_odb_backend* m_backend = nullptr;
+
+    std::unordered_set<git_oid, oid_hash, oid_equal> m_flushed;
+
+    bool in_memory(const git_oid& oid);
+};
+
+}
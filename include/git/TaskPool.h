@@ -0,0 +1,213 @@
+#pragma once
+
+#include "git/types.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include <git2/types.h>
+
+namespace git {
+
+/**
+ * @brief Priority of a task.
+ */
+enum class TaskPriority {
+    // the user waits for the result
+    HIGH,
+    NORMAL,
+    // results that may be needed later
+    LOW,
+};
+
+/**
+ * @brief Cancellation flag and progress of a task, shared by the task and its owner.
+ */
+class TaskToken {
+public:
+    // total is zero if it is not known
+    using progress_cb_t = std::function<void(std::uint32_t done, std::uint32_t total)>;
+
+    void cancel() { m_cancelled.store(true); }
+
+    [[nodiscard]] bool is_cancelled() const { return m_cancelled.load(); }
+
+    /**
+     * @brief Gets the flag for functions that check the cancellation themselves.
+     */
+    [[nodiscard]] const std::atomic_bool& flag() const { return m_cancelled; }
+
+    /**
+     * @brief Sets the function called with the reported progress.
+     *
+     * @details Must be set by the task before the progress is reported. The function is called by the reporting
+     * thread, so it should only post the progress (e.g. a queued QMetaObject::invokeMethod).
+     *
+     * @param cb Progress callback.
+     */
+    void on_progress(progress_cb_t cb) { m_progress_cb = std::move(cb); }
+
+    /**
+     * @brief Reports the progress of the task.
+     *
+     * @details The callback is called at most once per PROGRESS_INTERVAL_MS and always for the finished progress.
+     * Can be called by several threads.
+     *
+     * @param done Finished part.
+     * @param total Whole task, zero if it is not known.
+     */
+    void set_progress(std::uint32_t done, std::uint32_t total);
+
+    [[nodiscard]] std::uint32_t done() const { return m_done.load(); }
+
+    [[nodiscard]] std::uint32_t total() const { return m_total.load(); }
+
+private:
+    static constexpr std::int64_t PROGRESS_INTERVAL_MS = 100;
+
+    std::atomic_bool m_cancelled = false;
+    std::atomic_uint32_t m_done  = 0;
+    std::atomic_uint32_t m_total = 0;
+
+    progress_cb_t m_progress_cb;
+    // time of the last report in milliseconds
+    std::atomic_int64_t m_reported = 0;
+};
+
+/**
+ * @brief Work-stealing thread pool with a repository per worker.
+ *
+ * @details Every worker owns a repository over the object database of the attached repository, so the objects in
+ * memory are visible to the tasks. Tasks are queued on the workers in turns, an idle worker steals tasks of the
+ * other workers. Tasks with a higher priority are always started first. The repository passed to a task must not
+ * outlive it, results are posted to the UI thread by the task (e.g. a queued QMetaObject::invokeMethod).
+ */
+class TaskPool {
+public:
+    // the token can be kept by the results posted from the task
+    using task_t = std::function<void(git_repository* repo, const std::shared_ptr<TaskToken>& token)>;
+
+    TaskPool();
+    ~TaskPool();
+
+    TaskPool(const TaskPool&)            = delete;
+    TaskPool(TaskPool&&)                 = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+    TaskPool& operator=(TaskPool&&)      = delete;
+
+    /**
+     * @brief Shares the object database of the repository with the workers.
+     *
+     * @details Queued tasks of the previous repository are cancelled.
+     *
+     * @param repo Git repository.
+     *
+     * @return True if successful.
+     */
+    bool attach(git_repository* repo);
+
+    /**
+     * @brief Cancels queued tasks and releases the object database.
+     */
+    void detach();
+
+    /**
+     * @brief Cancels all tasks and joins the workers.
+     *
+     * @details Waits until the running tasks return. The repositories of the workers and the object database are
+     * released, so it must be called before libgit2 is shut down. No task is started afterwards.
+     */
+    void shutdown();
+
+    /**
+     * @brief Queues a task.
+     *
+     * @param priority Priority of the task.
+     * @param task Task to run on a worker.
+     *
+     * @return Token of the task or nullptr if no repository is attached.
+     */
+    std::shared_ptr<TaskToken> submit(TaskPriority priority, task_t task);
+
+    /**
+     * @brief Runs a task for every index and waits for all of them.
+     *
+     * @details The calling thread runs the task too, with its own repository, so the batch finishes even if the
+     * workers are busy. A task calling it should pass its priority and token, the remaining indices are skipped once
+     * the token is cancelled.
+     *
+     * @param repo Repository used by the calling thread.
+     * @param count Number of indices.
+     * @param task Task called with the repository of the thread and the index.
+     * @param priority Priority of the helper tasks.
+     * @param token Token receiving the number of finished indices, may be nullptr.
+     *
+     * @return False if any task failed or the batch was cancelled.
+     */
+    bool run_batch(
+        git_repository* repo,
+        std::size_t count,
+        const std::function<bool(git_repository*, std::size_t)>& task,
+        TaskPriority priority = TaskPriority::HIGH,
+        TaskToken* token      = nullptr
+    );
+
+    /**
+     * @brief Gets global TaskPool instance.
+     */
+    static TaskPool& get() {
+        static TaskPool pool;
+        return pool;
+    }
+
+private:
+    static constexpr std::size_t PRIORITY_COUNT = 3;
+
+    // object database of the attached repository, kept alive by the queued tasks
+    struct source_t {
+        odb_t odb;
+    };
+
+    struct job_t {
+        task_t task;
+        std::shared_ptr<TaskToken> token;
+        std::shared_ptr<source_t> source;
+    };
+
+    struct worker_t {
+        std::mutex lock;
+        std::array<std::deque<job_t>, PRIORITY_COUNT> queues;
+
+        // token of the task being run, cancelled by the shutdown
+        std::shared_ptr<TaskToken> running;
+    };
+
+    std::vector<std::unique_ptr<worker_t>> m_workers;
+    std::atomic_size_t m_next_worker = 0;
+
+    std::shared_ptr<source_t> m_source;
+
+    // number of queued tasks, the workers sleep while it is zero
+    std::mutex m_lock;
+    std::condition_variable_any m_wake;
+    std::size_t m_queued = 0;
+
+    // must be destroyed first, the workers use the queues
+    std::vector<std::jthread> m_threads;
+
+    void run(std::size_t self, const std::stop_token& stop);
+
+    bool take(std::size_t self, job_t& job);
+};
+
+}
@@ -1,11 +1,15 @@
 #pragma once
 
 #include "action/Action.h"
+#include "git/TaskPool.h"
 #include "git/types.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <git2/diff.h>
@@ -14,25 +18,13 @@
 
 namespace git {
 
-/**
- * @brief Result of a diff preparation operation.
- */
-struct diff_result_t {
-    enum State {
-        FAILED_TO_RETRIEVE_TREE,
-        FAILED_TO_CREATE_DIFF,
-        OK,
-    };
-
-    State state = State::OK;
-    diff_t diff;
-};
-
 /**
  * @brief Represents a file involved in a diff.
+ *
+ * @details The path points into the diff, which stores every path only once.
  */
 struct diff_file_t {
-    std::string path;
+    std::string_view path;
     git_oid id;
 };
 
@@ -46,6 +38,8 @@ struct hunk_lines_info {
 
 /**
  * @brief Represents a single line in a diff hunk.
+ *
+ * @details The content points into the patch of the file.
  */
 struct diff_line_t {
     enum class Type {
@@ -61,7 +55,7 @@ struct diff_line_t {
     int old_lineno;
     int new_lineno;
 
-    std::string content;
+    std::string_view content;
 };
 
 /**
@@ -71,13 +65,16 @@ struct diff_hunk_t {
     hunk_lines_info new_file;
     hunk_lines_info old_file;
 
-    std::string header_context;
+    std::string_view header_context;
 
     std::vector<diff_line_t> lines;
 };
 
 /**
  * @brief Represents a full file diff.
+ *
+ * @details The file owns the patch that stores the hunk headers and lines. Hunks are generated only after the file
+ * is loaded by load_diff_file.
  */
 struct diff_files_t {
     enum class State {
@@ -101,6 +98,10 @@ struct diff_files_t {
 
     std::vector<diff_hunk_t> hunks;
 
+    patch_t patch;
+
+    bool loaded = false;
+
     static constexpr const char* state_to_str(State state) {
         switch (state) {
         case State::UNMODIFIED:
@@ -131,6 +132,33 @@ struct diff_files_t {
     }
 };
 
+/**
+ * @brief Parsed diff that owns all referenced buffers.
+ */
+struct diff_model_t {
+    // set only for detached diffs, the diff does not own its repository
+    repository_t repo;
+    diff_t diff;
+    std::vector<diff_files_t> files;
+};
+
+/**
+ * @brief Result of a diff preparation operation.
+ *
+ * @details The parsed diff can be shared with the DiffCache.
+ */
+struct diff_result_t {
+    enum State {
+        FAILED_TO_RETRIEVE_TREE,
+        FAILED_TO_CREATE_DIFF,
+        CANCELLED,
+        OK,
+    };
+
+    State state = State::OK;
+    std::shared_ptr<diff_model_t> model;
+};
+
 /**
  * @brief Lightweight diff file header representation.
  */
@@ -152,13 +180,35 @@ struct conflict_diff_t {
 /**
  * @brief Creates a diff between two trees.
  *
+ * @details Diffs are looked up in the DiffCache first, diffs limited by a pathspec are never cached.
+ *
  * @param old_tree Base tree.
  * @param new_tree Target tree.
  * @param repo Git repository.
  * @param opts Diff options (optional).
+ * @param find_opts Rename detection options (optional).
  */
-diff_result_t
-prepare_diff(git_tree* old_tree, git_tree* new_tree, git_repository* repo, const git_diff_options* opts = nullptr);
+diff_result_t prepare_diff(
+    git_tree* old_tree,
+    git_tree* new_tree,
+    git_repository* repo,
+    const git_diff_options* opts = nullptr,
+    const git_diff_find_options* find_opts = nullptr
+);
+
+/**
+ * @brief Creates a diff between two trees in a private repository.
+ *
+ * @details Safe to call from a worker thread. The repository is created over the shared object database and is
+ * owned by the returned diff, so the diff can be used on any thread afterwards. The diff is not cached.
+ *
+ * @param odb Object database of the repository.
+ * @param old_tree Base tree (optional).
+ * @param new_tree Target tree (optional).
+ * @param token Token of the task, the diff is aborted once it is cancelled. The number of diffed files is reported
+ * as the progress, the total is not known.
+ */
+diff_result_t prepare_detached_diff(git_odb* odb, const git_oid* old_tree, const git_oid* new_tree, TaskToken& token);
 
 /**
  * @brief Creates a diff between two commits.
@@ -191,14 +241,37 @@ diff_result_t prepare_resolution_diff(
     git_tree* old_tree, action::Action* new_tree, git_repository* repo, const git_diff_options* opts = nullptr
 );
 
+/**
+ * @brief Gets tree of an action with the recorded conflict resolution applied.
+ *
+ * @param old_tree Tree the action is applied onto.
+ * @param action Action.
+ *
+ * @return Resolution tree or the tree of the action.
+ */
+git_tree* get_resolution_tree(git_tree* old_tree, action::Action* action);
+
 /**
  * @brief Converts raw git diff into structured file diffs.
  *
+ * @details Only the file headers are created, hunks are generated on demand by load_diff_file.
+ *
  * @param diff Git diff object.
+ * @param find_opts Rename detection options (optional).
+ *
+ * @return Parsed diff files that keep the diff alive or std::nullopt if the rename detection failed.
+ */
+std::optional<diff_model_t> create_diff(diff_t&& diff, const git_diff_find_options* find_opts = nullptr);
+
+/**
+ * @brief Generates hunks and lines of a file.
+ *
+ * @param model Diff created by create_diff.
+ * @param index Index of the file.
  *
- * @return Parsed diff files.
+ * @return True if successful or the file is already loaded.
  */
-std::vector<diff_files_t> create_diff(git_diff* diff);
+bool load_diff_file(diff_model_t& model, std::size_t index);
 
 /**
  * @brief Extracts header information from a file diff.
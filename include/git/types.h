@@ -19,7 +19,9 @@
 #include <git2/index.h>
 #include <git2/merge.h>
 #include <git2/object.h>
+#include <git2/odb.h>
 #include <git2/oid.h>
+#include <git2/pack.h>
 #include <git2/patch.h>
 #include <git2/refs.h>
 #include <git2/repository.h>
@@ -142,6 +144,8 @@ using conflict_iterator_t = ptr_object_t<git_index_conflict_iterator, git_index_
 using index_iterator_t    = ptr_object_t<git_index_iterator, git_index_iterator_free>;
 using blob_t              = ptr_object_t<git_blob, git_blob_free>;
 using repository_t        = ptr_object_t<git_repository, git_repository_free>;
+using odb_t               = ptr_object_t<git_odb, git_odb_free>;
+using packbuilder_t       = ptr_object_t<git_packbuilder, git_packbuilder_free>;
 
 using buffer_t = object_t<git_buf, git_buf_dispose>;
 
@@ -264,4 +268,23 @@ template <std::uint8_t HashSize = 7> std::string format_oid_to_str(const git_oid
     return std::string(arr.begin());
 }
 
+/**
+ * @brief Hash of a Git OID.
+ */
+struct oid_hash {
+    std::size_t operator()(const git_oid& oid) const {
+        // OIDs are uniformly distributed, the prefix is enough
+        std::size_t hash;
+        std::memcpy(&hash, oid.id, sizeof(hash));
+        return hash;
+    }
+};
+
+/**
+ * @brief Equality of Git OIDs.
+ */
+struct oid_equal {
+    bool operator()(const git_oid& a, const git_oid& b) const { return git_oid_equal(&a, &b) != 0; }
+};
+
 }
@@ -16,6 +16,7 @@ class ConflictStyle : public QObject {
         UNKNOWN           = 1,
         CONFLICT          = 2,
         RESOLVED_CONFLICT = 3,
+        COMMUTES          = 4,
         _LENGTH,
     };
 
@@ -24,6 +25,7 @@ class ConflictStyle : public QObject {
         "Unknown",
         "Conflict",
         "ResolvedConflict",
+        "Commutes",
     });
 
     static_assert(STYLE_NAMES.size() == Style::_LENGTH);
@@ -33,6 +35,7 @@ class ConflictStyle : public QObject {
         { 233, 196, 106 },
         { 239, 91, 111 },
         { 128, 26, 134 },
+        { 42, 157, 143 },
     };
 
     void set(Style style, const QColor& color);
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "action/ActionManager.h"
+#include "gui/widget/ListItem.h"
+
+#include <vector>
+
+#include <QAbstractListModel>
+#include <QModelIndex>
+#include <QObject>
+#include <QVariant>
+#include <Qt>
+
+namespace gui::widget {
+
+/**
+ * @brief List model of the actions.
+ *
+ * @details Every row holds only the state of the action (see ListItem), the rows are painted by the
+ * ListItemDelegate. A move of a row moves only its state.
+ */
+class ActionListModel : public QAbstractListModel {
+public:
+    ActionListModel(QObject* parent = nullptr)
+        : QAbstractListModel(parent) { }
+
+    /**
+     * @brief Replaces the rows by the actions of the manager.
+     */
+    void setActions(action::ActionsManager& manager);
+
+    void clear();
+
+    /**
+     * @brief Gets the state of the row.
+     *
+     * @return State or nullptr if the row does not exist.
+     */
+    ListItem* item(int row);
+
+    [[nodiscard]] const ListItem* item(int row) const { return const_cast<ActionListModel*>(this)->item(row); }
+
+    ListItem* item(const QModelIndex& index) { return item(index.row()); }
+
+    [[nodiscard]] const ListItem* item(const QModelIndex& index) const { return item(index.row()); }
+
+    [[nodiscard]] int count() const { return static_cast<int>(m_items.size()); }
+
+    /**
+     * @brief Repaints the row of the item.
+     */
+    void itemChanged(const ListItem& item);
+
+    [[nodiscard]] int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+    [[nodiscard]] QVariant data(const QModelIndex& index, int role) const override;
+
+    [[nodiscard]] Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+    [[nodiscard]] Qt::DropActions supportedDropActions() const override { return Qt::MoveAction; }
+
+    bool moveRows(
+        const QModelIndex& source_parent,
+        int source_row,
+        int count,
+        const QModelIndex& destination_parent,
+        int destination_child
+    ) override;
+
+private:
+    std::vector<ListItem> m_items;
+};
+
+}
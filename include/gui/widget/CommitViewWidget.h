@@ -3,6 +3,7 @@
 #include "action/Action.h"
 #include "action/ActionManager.h"
 #include "git/diff.h"
+#include "git/types.h"
 #include "gui/widget/CommitMessageWidget.h"
 #include "gui/widget/DiffWidget.h"
 #include "gui/widget/graph/Node.h"
@@ -44,6 +45,9 @@ class CommitViewWidget : public QWidget {
     action::Action* m_action = nullptr;
     git_commit* m_commit     = nullptr;
 
+    // NOTE: The commit of a node is owned by the CommitCache and may be evicted
+    git::commit_t m_node_commit;
+
     void createRows();
     void prepareDiff();
 
@@ -14,6 +14,7 @@
 #include <QVBoxLayout>
 #include <QWidget>
 
+#include <cstddef>
 #include <utility>
 
 namespace gui::widget {
@@ -87,6 +88,14 @@ class DiffFile : public QWidget {
 
     [[nodiscard]] const git::diff_files_header_t& getDiff() const { return m_diff; }
 
+    void setIndex(std::size_t index) { m_index = index; }
+
+    [[nodiscard]] std::size_t getIndex() const { return m_index; }
+
+    void setLoaded() { m_loaded = true; }
+
+    [[nodiscard]] bool isLoaded() const { return m_loaded; }
+
     DiffEditor* getEditor() { return m_editor; }
 
     void updateEditorHeight() { update_editor_height(m_editor); }
@@ -96,7 +105,9 @@ class DiffFile : public QWidget {
     QLabel* m_label;
     DiffEditor* m_editor;
     git::diff_files_header_t m_diff;
-    bool m_selected = false;
+    std::size_t m_index = 0;
+    bool m_loaded       = false;
+    bool m_selected     = false;
 };
 
 }
@@ -2,6 +2,7 @@
 
 #include "action/Action.h"
 #include "git/diff.h"
+#include "git/TaskPool.h"
 #include "git/types.h"
 #include "gui/style/DiffStyle.h"
 #include "gui/widget/DiffEditor.h"
@@ -9,11 +10,14 @@
 #include "state/Command.h"
 
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <utility>
 #include <vector>
 
 #include <git2/types.h>
 
+#include <QLabel>
 #include <QScrollArea>
 #include <QTextBlock>
 #include <QTextEdit>
@@ -23,9 +27,10 @@
 namespace gui::widget {
 
 class DiffWidget : public QWidget {
+    Q_OBJECT
 public:
     DiffWidget(QWidget* parent = nullptr);
-    ~DiffWidget() override = default;
+    ~DiffWidget() override;
 
     void update(action::Action* act);
     void update(git_commit* commit);
@@ -33,17 +38,30 @@ class DiffWidget : public QWidget {
 
     void clear();
 
-    [[nodiscard]] const std::vector<git::diff_files_t>& getDiffs() const { return m_diffs; }
+    [[nodiscard]] const std::vector<git::diff_files_t>& getDiffs() const { return m_diffs->files; }
 
-    DiffFile* getDiffFile(std::size_t i) { return m_files[i]; }
+    DiffFile* getDiffFile(std::size_t i);
 
     void ensureEditorVisible(DiffFile* file);
 
+signals:
+    void diffChanged();
+
 private:
+    static constexpr std::size_t FILES_PER_BATCH = 32;
+
     action::Action* m_action = nullptr;
 
-    std::vector<git::diff_files_t> m_diffs;
+    std::shared_ptr<git::diff_model_t> m_diffs = std::make_shared<git::diff_model_t>();
     std::vector<DiffFile*> m_files;
+    std::size_t m_created_files = 0;
+    std::uint64_t m_generation  = 0;
+    bool m_editable             = false;
+
+    // token of the running diff
+    std::shared_ptr<git::TaskToken> m_task;
+    QLabel* m_loading;
+
     QVBoxLayout* m_scroll_layout;
     QVBoxLayout* m_layout;
     QScrollArea* m_scrollarea;
@@ -58,7 +76,13 @@ class DiffWidget : public QWidget {
         QTextBlock block;
     };
 
-    void createFileDiff(const git::diff_files_t& diff, bool editable);
+    void requestDiff(git_tree* old_tree, git_tree* new_tree, bool editable);
+    void cancelDiff();
+    void createFiles(std::size_t count);
+    void streamFiles();
+    void createFileDiff(std::size_t index, bool editable);
+    void loadFileDiff(DiffFile* file);
+    void loadVisibleFiles();
     void addHunkDiff(const git::diff_hunk_t& hunk, std::vector<section_t>& sections);
     void addLineDiff(
         QTextCursor& cursor,
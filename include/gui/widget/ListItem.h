@@ -1,36 +1,37 @@
 #pragma once
 
 #include "action/Action.h"
+#include "action/ActionManager.h"
 #include "conflict/conflict.h"
 #include "gui/widget/graph/Node.h"
-#include "logging/Log.h"
 #include "state/Command.h"
 
-#include <array>
-#include <cassert>
-
-#include <QBoxLayout>
-#include <QColor>
-#include <QComboBox>
-#include <QLabel>
-#include <QListWidgetItem>
-#include <QObject>
-#include <QPalette>
-#include <QString>
-#include <QWidget>
-
 namespace gui::widget {
 
+class ActionListModel;
 class RebaseViewWidget;
 
-class ListItem : public QWidget {
-    Q_OBJECT
+/**
+ * @brief State of a row in the action list.
+ *
+ * @details The row is painted by the ListItemDelegate, a change of the state repaints only the row.
+ */
+class ListItem {
 public:
     using ActionType = action::ActionType;
 
     static constexpr auto items = action::action_types;
     using ConflictStatus        = conflict::ConflictStatus;
 
+    /**
+     * @brief Result of moving the dragged action over this item.
+     */
+    enum class DropTarget {
+        NONE,
+        COMMUTES,
+        CONFLICTS,
+    };
+
     static constexpr int indexOf(ActionType type) {
         for (int i = 0; i < static_cast<int>(items.size()); ++i) {
             if (items[i] == type) {
@@ -41,76 +42,59 @@ class ListItem : public QWidget {
         return -1;
     }
 
-    ListItem(RebaseViewWidget* rebase, QListWidget* list, int row, action::Action& action);
+    ListItem(ActionListModel* model, action::Action& action)
+        : m_action(&action)
+        , m_model(model) { }
 
-    QComboBox* getComboBox() { return m_combo; }
+    [[nodiscard]] const action::Action& getCommitAction() const { return *m_action; }
 
-    [[nodiscard]] const action::Action& getCommitAction() const { return m_action; }
-
-    [[nodiscard]] action::Action& getCommitAction() { return m_action; }
+    [[nodiscard]] action::Action& getCommitAction() { return *m_action; }
 
     void setNode(Node* node) { m_node = node; }
 
-    void setText(const QString& text) { m_text->setText(text); }
-
     Node* getNode() { return m_node; }
 
-    [[nodiscard]] int getRow() const { return m_row; }
-
     void setConflict(ConflictStatus status);
 
-    void setActionType(ActionType type) {
-        LOG_INFO(
-            "Changing action type: from {} to {}", action::type_to_str(m_action.get_type()), action::type_to_str(type)
-        );
-        auto index = indexOf(type);
-        assert(index != -1);
+    [[nodiscard]] ConflictStatus getConflict() const { return m_conflict; }
 
-        m_combo->setCurrentIndex(index);
-        m_action.set_type(type);
-    }
+    void setDropTarget(DropTarget target);
 
-    void setActionTypeNoSignal(ActionType type) {
-        m_combo->blockSignals(true);
-        setActionType(type);
-        m_combo->blockSignals(false);
-    }
+    [[nodiscard]] DropTarget getDropTarget() const { return m_drop_target; }
+
+    /**
+     * @brief Shows the conflict status as outdated until the action is replayed.
+     */
+    void setPending(bool pending);
+
+    [[nodiscard]] bool isPending() const { return m_pending; }
+
+    void setActionType(ActionType type);
 
     void showConflictMarker() { setConflictMarker(true); }
 
     void hideConflictMarker() { setConflictMarker(false); }
 
-    void setConflictMarker(bool visible) {
-        if (visible) {
-            m_marker->show();
-        } else {
-            m_marker->hide();
-        }
-    }
+    void setConflictMarker(bool visible);
 
-    bool eventFilter(QObject* obj, QEvent* event) override;
+    [[nodiscard]] bool hasConflictMarker() const { return m_marker; }
 
 private:
     Node* m_node = nullptr;
-    action::Action& m_action;
-    conflict::ConflictStatus m_conflict;
-
-    RebaseViewWidget* m_rebase;
-    QListWidget* m_parent;
-    int m_row;
-
-    QLabel* m_text;
-    QLabel* m_marker;
-    QHBoxLayout* m_layout;
+    action::Action* m_action;
+    ActionListModel* m_model;
 
-    QComboBox* m_combo;
+    ConflictStatus m_conflict = ConflictStatus::UNKNOWN;
+    DropTarget m_drop_target  = DropTarget::NONE;
+    bool m_pending            = false;
+    bool m_marker             = false;
 
-    void updateMarkerColor();
+    void changed();
 };
 
 class ListItemMoveCommand : public state::Command {
 public:
-    ListItemMoveCommand(RebaseViewWidget* rebase, QListWidget* parent, int prev_row, int curr_row);
+    ListItemMoveCommand(RebaseViewWidget* rebase, ActionListModel* model, int prev_row, int curr_row);
     ~ListItemMoveCommand() override = default;
 
     void execute() override;
@@ -118,7 +102,7 @@ class ListItemMoveCommand : public state::Command {
 
 private:
     RebaseViewWidget* m_rebase;
-    QListWidget* m_parent;
+    ActionListModel* m_model;
     int m_prev;
     int m_curr;
 
@@ -127,14 +111,14 @@ class ListItemMoveCommand : public state::Command {
 
 class ListItemChangedCommand : public state::Command {
 public:
-    ListItemChangedCommand(QListWidget* parent, int row, action::ActionType prev, action::ActionType curr);
+    ListItemChangedCommand(ActionListModel* model, int row, action::ActionType prev, action::ActionType curr);
     ~ListItemChangedCommand() override = default;
 
     void execute() override;
     void undo() override;
 
 private:
-    QListWidget* m_parent;
+    ActionListModel* m_model;
     int m_row;
     action::ActionType m_prev;
     action::ActionType m_curr;
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QAbstractItemView>
+#include <QEvent>
+#include <QModelIndex>
+#include <QObject>
+#include <QPainter>
+#include <QRect>
+#include <QSize>
+#include <QStyledItemDelegate>
+#include <QStyleOptionViewItem>
+#include <QWidget>
+
+namespace gui::widget {
+
+/**
+ * @brief Paints the rows of the action list.
+ *
+ * @details The type selector is only drawn, a combo box is created when the selector is clicked or the row is
+ * edited from the keyboard.
+ */
+class ListItemDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+
+public:
+    ListItemDelegate(QAbstractItemView* view);
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+    [[nodiscard]] QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+    QWidget* createEditor(QWidget* parent, const QStyleOptionViewItem& option, const QModelIndex& index)
+        const override;
+
+    void setEditorData(QWidget* editor, const QModelIndex& index) const override;
+
+    void setModelData(QWidget* editor, QAbstractItemModel* model, const QModelIndex& index) const override;
+
+    void updateEditorGeometry(QWidget* editor, const QStyleOptionViewItem& option, const QModelIndex& index)
+        const override;
+
+    bool editorEvent(
+        QEvent* event, QAbstractItemModel* model, const QStyleOptionViewItem& option, const QModelIndex& index
+    ) override;
+
+private slots:
+    void commitAndCloseEditor();
+
+private:
+    static constexpr int HEIGHT      = 22;
+    static constexpr int SPACING     = 2;
+    static constexpr int MARKER_SIZE = 16;
+
+    // keeps the text readable
+    static constexpr int DROP_TARGET_ALPHA = 80;
+
+    QAbstractItemView* m_view;
+
+    // width of the type selector, computed once
+    mutable int m_type_width = -1;
+
+    [[nodiscard]] QRect typeRect(const QStyleOptionViewItem& option) const;
+};
+
+}
@@ -5,14 +5,19 @@
 #include "conflict/ConflictManager.h"
 #include "git/GitGraph.h"
 #include "git/parser.h"
+#include "git/TaskPool.h"
 #include "git/types.h"
+#include "gui/widget/ActionListModel.h"
 #include "gui/widget/CommitViewWidget.h"
 #include "gui/widget/ConflictWidget.h"
 #include "gui/widget/DiffWidget.h"
 #include "gui/widget/graph/Graph.h"
 #include "gui/widget/graph/Node.h"
 #include "gui/widget/ListItem.h"
+#include "gui/widget/ScrollListWidget.h"
 
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
@@ -23,16 +28,17 @@
 #include <QBoxLayout>
 #include <QGridLayout>
 #include <QLabel>
-#include <QListWidgetItem>
 #include <QObject>
 #include <QPushButton>
 #include <QSplitter>
 #include <QStackedLayout>
+#include <QTimer>
 #include <QWidget>
 
 namespace gui::widget {
 
 class RebaseViewWidget : public QWidget {
+    Q_OBJECT
 public:
     RebaseViewWidget(QWidget* parent = nullptr);
     std::optional<std::string> update(
@@ -64,7 +70,7 @@ class RebaseViewWidget : public QWidget {
 
     void ignoreMoveSignal(bool enable) { m_ignore_move = enable; }
 
-    QListWidget* getList() { return m_list_actions; }
+    ScrollListWidget* getList() { return m_list_actions; }
 
     void moveActionDown() { moveSelectedAction(true); }
 
@@ -76,17 +82,41 @@ class RebaseViewWidget : public QWidget {
 
     void changeActionType(action::ActionType type);
 
-    void updateConflicts(action::Action* start) {
-        updateConflictList(start);
-        updateConflictMarkers();
-    }
+    /**
+     * @brief Schedules the replay of the changed actions.
+     *
+     * @details The edit is already stored in the actions manager. The changed ranges of consecutive edits are merged
+     * and replayed once the edits stop for a while, together with the conflict markers and the graph. The affected
+     * rows are shown as pending until then.
+     *
+     * @param start The first changed action, @c nullptr for the first action.
+     * @param converge The first action not affected by the change, @c nullptr if all following actions are affected.
+     */
+    void updateConflicts(action::Action* start, action::Action* converge = nullptr);
+
+    /**
+     * @brief Runs the scheduled replay immediately and updates the markers and the graph.
+     */
+    void flushConflicts();
+
+signals:
+    /**
+     * @brief Reports the commits of the commutativity matrix diffed on a worker.
+     *
+     * @details Emitted on the UI thread, the update finished or was cancelled once done equals total.
+     *
+     * @param done Diffed commits.
+     * @param total Commits to diff.
+     */
+    void matrixProgress(std::uint32_t done, std::uint32_t total);
 
 private:
     /* UI */
     GraphWidget* m_old_commits_graph;
     GraphWidget* m_new_commits_graph;
 
-    QListWidget* m_list_actions;
+    ScrollListWidget* m_list_actions;
+    ActionListModel* m_list_model;
 
     CommitViewWidget* m_commit_view;
     DiffWidget* m_diff_widget;
@@ -121,6 +151,37 @@ class RebaseViewWidget : public QWidget {
     std::vector<conflict::ConflictEntry> m_conflict_entries;
     std::vector<git_oid> m_conflict_files;
 
+    /* Conflict scan */
+    static constexpr std::int64_t SCAN_SLICE_MS          = 8;
+    static constexpr std::int64_t SCAN_PRIORITY_SLICE_MS = 50;
+
+    struct {
+        action::Action* next;
+        action::Action* parent;
+        action::Action* converge;
+        bool can_converge;
+        bool running;
+        std::uint64_t generation;
+    } m_scan {};
+
+    /* Scheduled replay */
+    static constexpr int RECOMPUTE_DELAY_MS = 150;
+
+    QTimer* m_recompute_timer;
+
+    struct {
+        action::Action* start;
+        action::Action* converge;
+        bool pending;
+    } m_recompute {};
+
+    /* Drop preview */
+    int m_drag_row = -1;
+    std::shared_ptr<git::TaskToken> m_preview_task;
+
+    /* Commutativity matrix */
+    std::shared_ptr<git::TaskToken> m_matrix_task;
+
 private:
     std::optional<std::string> prepareGitGraph(git_repository* repo, const std::string& head, const std::string& onto);
 
@@ -134,19 +195,78 @@ class RebaseViewWidget : public QWidget {
 
     void prepareGraph();
 
-    ListItem* getListItem(int index) {
-        auto* item = m_list_actions->item(index);
-        if (item == nullptr) {
-            return nullptr;
-        }
-
-        return dynamic_cast<ListItem*>(m_list_actions->itemWidget(item));
-    }
+    ListItem* getListItem(int index) { return m_list_model->item(index); }
 
     void changeItemSelection();
     void showConflict(Node* node);
 
-    void updateConflictList(action::Action* start);
+    /**
+     * @brief Colours the rows by whether the dragged action can be moved there without a conflict.
+     *
+     * @details Only the precomputed overlaps of the changed lines are used, nothing is merged. Rows that depend on
+     * commits missing in the matrix are not coloured.
+     *
+     * @param row Row of the dragged action.
+     */
+    void markDropTargets(int row);
+
+    void clearDropTargets();
+
+    /**
+     * @brief Diffs the commits missing in the commutativity matrix on a worker and adds them once they are ready.
+     */
+    void updateCommuteMatrix();
+
+    void cancelMatrixUpdate();
+
+    /**
+     * @brief Replays the plan as if the dragged action was dropped at the row and colours the drop indicator.
+     *
+     * @details Cached merge results are used first, the remaining merges run on a worker. Only the moved rows are
+     * replayed.
+     *
+     * @param target Row the dragged action would end up in.
+     */
+    void previewDrop(int target);
+
+    void showPreviewResult(conflict::ConflictStatus status);
+
+    void cancelPreview();
+
+    void cancelRecompute();
+
+    /**
+     * @brief Replays the actions and updates their trees.
+     *
+     * @param start The first action to replay.
+     * @param converge The first action not affected by the change. From this action on, the replay stops once
+     *                 the resulting tree matches the previous one.
+     */
+    void updateConflictList(action::Action* start, action::Action* converge = nullptr);
+
+    /**
+     * @brief Replays the actions in the background and updates the markers as the results arrive.
+     *
+     * @param start The first action to replay.
+     */
+    void scanConflicts(action::Action* start);
+
+    void continueConflictScan(std::uint64_t generation);
+
+    void beginConflictScan(action::Action* start, action::Action* converge);
+
+    /**
+     * @brief Replays the next action of the scan.
+     *
+     * @return False if there is nothing left to replay.
+     */
+    bool stepConflictScan();
+
+    void showConflictStatus(action::Action* act);
+
+    int lastPriorityRow();
+
+    void refreshLastConflict(action::Action* start);
 
     void updateConflictMarkers();
 
@@ -1,21 +1,49 @@
 #pragma once
 
-#include <QListWidget>
+#include <QColor>
+#include <QListView>
 #include <QObject>
+#include <Qt>
 #include <QTimer>
 #include <QWidget>
 
 namespace gui::widget {
-class ScrollListWidget : public QListWidget {
+class ScrollListWidget : public QListView {
     Q_OBJECT
 
 public:
     explicit ScrollListWidget(QWidget* parent = nullptr);
 
+    [[nodiscard]] int count() const { return (model() != nullptr) ? model()->rowCount() : 0; }
+
+    [[nodiscard]] int currentRow() const { return currentIndex().row(); }
+
+    void setCurrentRow(int row) { setCurrentIndex(model()->index(row, 0)); }
+
+    /**
+     * @brief Sets color of the line drawn over the drop indicator.
+     *
+     * @param color Line color, invalid color hides the line.
+     */
+    void setDropIndicatorColor(const QColor& color);
+
+signals:
+    void dragStarted(int row);
+
+    /**
+     * @brief Emitted when the row the dragged item would end up in changes.
+     */
+    void dragTargetChanged(int row);
+
+    void dragFinished();
+
 protected:
+    void startDrag(Qt::DropActions supported_actions) override;
     void dragMoveEvent(QDragMoveEvent* event) override;
     void dragLeaveEvent(QDragLeaveEvent* event) override;
     void dropEvent(QDropEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+    void keyPressEvent(QKeyEvent* event) override;
 
 private slots:
     void autoScroll();
@@ -30,8 +58,18 @@ private slots:
         NONE = 0,
     };
 
+    static constexpr int DROP_LINE_WIDTH = 3;
+
     QTimer* m_timer;
     ScrollDirection m_dir;
+
+    int m_drag_row   = -1;
+    int m_target_row = -1;
+    // position of the line in the viewport
+    int m_drop_y = -1;
+    QColor m_drop_color;
+
+    void updateDropTarget(const QPoint& pos);
 };
 
 }
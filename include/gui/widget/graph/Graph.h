@@ -1,19 +1,32 @@
 #pragma once
 
+#include "git/types.h"
 #include "Node.h"
+#include "utils/flat_map.h"
 
 #include <cassert>
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <vector>
 
-#include <QGraphicsView>
+#include <git2/oid.h>
+
+#include <QAbstractScrollArea>
 #include <QObject>
+#include <QRect>
 #include <QWidget>
 
 namespace gui::widget {
 
-class GraphWidget : public QGraphicsView {
+/**
+ * @brief Commit graph drawn row by row.
+ *
+ * @details Nodes are plain rows, only the rows inside the viewport are painted. Rows have a fixed height, so the
+ * row under the cursor is computed from the scroll position and the width of the rows follows the viewport without
+ * touching the nodes.
+ */
+class GraphWidget : public QAbstractScrollArea {
 public:
     GraphWidget(QWidget* parent = nullptr);
 
@@ -24,24 +37,61 @@ class GraphWidget : public QGraphicsView {
     void clear();
 
     Node* nodeAt(int i) {
-        assert(i >= 0 && i < static_cast<int>(m_nodes.size()));
-        return m_nodes[i];
+        assert(i >= 0 && i < static_cast<int>(m_rows.size()));
+        return m_rows[i];
     }
 
-    Node* find(std::function<bool(const Node*)> prec);
+    /**
+     * @brief Finds the node of a commit.
+     *
+     * @param id Commit ID.
+     *
+     * @return Node or nullptr if the commit is not in the graph.
+     */
+    Node* find(const git_oid& id);
 
     void setHandle(const std::function<void(Node*, Node*)>& handle) { m_handle = handle; }
 
+    /**
+     * @brief Repaints the row of the node if it is visible.
+     */
+    void updateNode(const Node* node);
+
+    /**
+     * @brief Adds the node to the commit index, called when the commit of the node changes.
+     */
+    void indexNode(const Node* node);
+
 protected:
     void mousePressEvent(QMouseEvent* event) override;
 
     void resizeEvent(QResizeEvent* event) override;
 
+    void paintEvent(QPaintEvent* event) override;
+
+    void scrollContentsBy(int dx, int dy) override;
+
 private:
+    static constexpr int PADDING    = 2;
+    static constexpr int GAP        = 2;
+    static constexpr int ROW_HEIGHT = static_cast<int>(Node::HEIGHT) + GAP;
+
     std::uint32_t m_next_y                     = 0;
     std::function<void(Node*, Node*)> m_handle = defaultHandle;
 
-    std::vector<Node*> m_nodes;
+    // NOTE: The deque keeps the nodes in place, the rows point to them
+    std::deque<Node> m_nodes;
+    std::vector<Node*> m_rows;
+
+    utils::flat_map<git_oid, std::uint32_t, git::oid_hash, git::oid_equal> m_index;
+
+    Node* m_selected = nullptr;
+
+    [[nodiscard]] QRect rowRect(std::uint32_t row) const;
+
+    [[nodiscard]] int rowsWidth() const;
+
+    void updateScrollBars();
 
     static void defaultHandle(Node* /*unused*/, Node* /*unused*/) { }
 };
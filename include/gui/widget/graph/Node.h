@@ -2,27 +2,26 @@
 
 #include "action/Action.h"
 #include "conflict/conflict.h"
-#include "git/types.h"
+#include "git/CommitCache.h"
 
-#include <git2/oid.h>
-#include <string>
+#include <cstdint>
 
-#include <git2/commit.h>
+#include <git2/oid.h>
 #include <git2/types.h>
 
 #include <QColor>
-#include <QGraphicsItem>
-#include <QPainterPath>
+#include <QPainter>
 #include <Qt>
 #include <QtTypes>
-#include <QWidget>
 
 namespace gui::widget {
 
 class GraphWidget;
 
-class Node : public QGraphicsObject {
-    Q_OBJECT
+/**
+ * @brief Row of the commit graph, painted by the GraphWidget.
+ */
+class Node {
 public:
     static constexpr qreal MIN_WIDTH = 300;
     static constexpr qreal HEIGHT    = 20;
@@ -30,33 +29,22 @@ class Node : public QGraphicsObject {
     using ConflictStatus = conflict::ConflictStatus;
     using Action         = action::Action;
 
-    Node(GraphWidget* graph);
-    ~Node() override = default;
-
-    static constexpr int Type = UserType + 1;
-
-    [[nodiscard]] int type() const override { return Type; }
+    Node(GraphWidget* graph, std::uint32_t row);
 
-    void setWidth(qreal width);
+    [[nodiscard]] std::uint32_t getRow() const { return m_row; }
 
-    void setCommit(git_commit* commit) {
-        auto id       = git::format_oid(commit);
-        m_commit      = commit;
-        m_commit_hash = id.data();
-        m_commit_msg  = git_commit_summary(commit);
-    }
-
-    void setMessage(const std::string& str) { m_commit_msg = str; }
+    void setCommitId(const git_oid& id);
 
     void setAction(Action* action) { m_action = action; }
 
     Action* getAction() { return m_action; }
 
-    git_commit* getCommit() { return m_commit; }
-
-    [[nodiscard]] const git_commit* getCommit() const { return m_commit; }
+    /**
+     * @brief Gets the commit of the node, the commit is loaded by the CommitCache.
+     */
+    git_commit* getCommit() { return git::CommitCache::get().find(m_commit_id); }
 
-    [[nodiscard]] const git_oid* getCommitId() const { return git_commit_id(m_commit); }
+    [[nodiscard]] const git_oid* getCommitId() const { return &m_commit_id; }
 
     Node* getParentNode() { return m_parent; }
 
@@ -70,19 +58,26 @@ class Node : public QGraphicsObject {
 
     void setFill(const QColor& color);
 
-    [[nodiscard]] QRectF boundingRect() const override;
-    [[nodiscard]] QPainterPath shape() const override;
-    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+    /**
+     * @brief Repaints the node.
+     */
+    void update();
+
+    /**
+     * @brief Paints the node, the painter is translated to the top left corner of the row.
+     *
+     * @param painter Painter.
+     * @param width Row width.
+     * @param is_selected Whether the node is selected.
+     */
+    void paint(QPainter* painter, qreal width, bool is_selected);
 
 private:
     GraphWidget* m_graph;
+    std::uint32_t m_row;
     QColor m_fill = Qt::white;
 
-    qreal m_width = MIN_WIDTH;
-
-    git_commit* m_commit;
-    std::string m_commit_hash;
-    std::string m_commit_msg;
+    git_oid m_commit_id {};
 
     Action* m_action = nullptr;
 
@@ -10,6 +10,7 @@
 #include <utility>
 #include <vector>
 
+#include <git2/oid.h>
 #include <git2/types.h>
 
 namespace state {
@@ -19,7 +20,7 @@ namespace state {
  */
 struct SaveData {
     std::vector<std::pair<action::Action, std::string>> actions;
-    std::vector<std::pair<conflict::ConflictEntry, std::string>> conflicts;
+    std::vector<std::pair<conflict::ConflictEntry, git_oid>> conflicts;
     std::vector<std::pair<conflict::ConflictTrees, git::tree_t>> conflict_trees;
     git::commit_t root;
 
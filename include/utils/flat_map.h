@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+/**
+ * @brief Hash map with open addressing.
+ *
+ * @details Entries are stored in a single array and collisions are resolved by linear probing, so a lookup neither
+ * allocates nor follows pointers. The capacity is a power of two, the map grows once it is 3/4 full. Entries can
+ * not be erased one by one.
+ *
+ * @tparam Key Key type.
+ * @tparam Value Value type.
+ * @tparam Hash Hash of the key.
+ * @tparam Equal Equality of keys.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>, typename Equal = std::equal_to<Key>>
+class flat_map {
+private:
+    using slot_t = std::optional<std::pair<Key, Value>>;
+
+    template <bool Constant> class iterator_t {
+    private:
+        using slots_t = std::conditional_t<Constant, const std::vector<slot_t>, std::vector<slot_t>>;
+        using ref_t   = std::conditional_t<Constant, const std::pair<Key, Value>&, std::pair<Key, Value>&>;
+
+    public:
+        iterator_t(slots_t* slots, std::size_t index)
+            : m_slots(slots)
+            , m_index(index) {
+            skip_empty();
+        }
+
+        iterator_t& operator++() {
+            m_index += 1;
+            skip_empty();
+            return *this;
+        }
+
+        ref_t operator*() const { return *(*m_slots)[m_index]; }
+
+        auto* operator->() const { return std::addressof(*(*m_slots)[m_index]); }
+
+        bool operator==(const iterator_t& other) const { return m_index == other.m_index; }
+
+    private:
+        slots_t* m_slots;
+        std::size_t m_index;
+
+        void skip_empty() {
+            while (m_index < m_slots->size() && !(*m_slots)[m_index].has_value()) {
+                m_index += 1;
+            }
+        }
+    };
+
+public:
+    using iterator       = iterator_t<false>;
+    using const_iterator = iterator_t<true>;
+
+    /**
+     * @brief Finds the value of a key.
+     *
+     * @return Value or nullptr if the key is missing.
+     */
+    Value* find(const Key& key) {
+        if (m_size == 0) {
+            return nullptr;
+        }
+
+        slot_t& slot = m_slots[probe(key)];
+        return slot.has_value() ? std::addressof(slot->second) : nullptr;
+    }
+
+    const Value* find(const Key& key) const { return const_cast<flat_map*>(this)->find(key); }
+
+    [[nodiscard]] bool contains(const Key& key) const { return find(key) != nullptr; }
+
+    /**
+     * @brief Inserts a value or replaces the value of an existing key.
+     *
+     * @return Stored value.
+     */
+    template <typename V> Value& insert_or_assign(const Key& key, V&& value) {
+        slot_t& slot = reserve_slot(key);
+
+        if (slot.has_value()) {
+            slot->second = std::forward<V>(value);
+        } else {
+            slot.emplace(key, std::forward<V>(value));
+            m_size += 1;
+        }
+
+        return slot->second;
+    }
+
+    /**
+     * @brief Gets the value of a key, a default value is inserted if the key is missing.
+     */
+    Value& operator[](const Key& key) {
+        slot_t& slot = reserve_slot(key);
+
+        if (!slot.has_value()) {
+            slot.emplace(key, Value {});
+            m_size += 1;
+        }
+
+        return slot->second;
+    }
+
+    /**
+     * @brief Allocates space for the number of entries.
+     */
+    void reserve(std::size_t count) {
+        std::size_t capacity = MIN_CAPACITY;
+        while (capacity * 3 < count * 4) {
+            capacity *= 2;
+        }
+
+        if (capacity > m_slots.size()) {
+            rehash(capacity);
+        }
+    }
+
+    void clear() {
+        m_slots.clear();
+        m_size = 0;
+    }
+
+    [[nodiscard]] std::size_t size() const { return m_size; }
+
+    [[nodiscard]] bool empty() const { return m_size == 0; }
+
+    iterator begin() { return { &m_slots, 0 }; }
+
+    iterator end() { return { &m_slots, m_slots.size() }; }
+
+    [[nodiscard]] const_iterator begin() const { return { &m_slots, 0 }; }
+
+    [[nodiscard]] const_iterator end() const { return { &m_slots, m_slots.size() }; }
+
+private:
+    static constexpr std::size_t MIN_CAPACITY = 16;
+
+    std::vector<slot_t> m_slots;
+    std::size_t m_size = 0;
+
+    // the slot of the key or the empty slot where it belongs
+    std::size_t probe(const Key& key) const {
+        const std::size_t mask = m_slots.size() - 1;
+
+        for (std::size_t i = Hash {}(key) & mask;; i = (i + 1) & mask) {
+            const slot_t& slot = m_slots[i];
+
+            if (!slot.has_value() || Equal {}(slot->first, key)) {
+                return i;
+            }
+        }
+    }
+
+    slot_t& reserve_slot(const Key& key) {
+        if ((m_size + 1) * 4 > m_slots.size() * 3) {
+            rehash(std::max(MIN_CAPACITY, m_slots.size() * 2));
+        }
+
+        return m_slots[probe(key)];
+    }
+
+    void rehash(std::size_t capacity) {
+        std::vector<slot_t> old = std::exchange(m_slots, std::vector<slot_t>(capacity));
+
+        for (auto& slot : old) {
+            if (slot.has_value()) {
+                m_slots[probe(slot->first)] = std::move(slot);
+            }
+        }
+    }
+};
+
+}
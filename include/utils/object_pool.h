@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+/**
+ * @brief Slab allocator for objects of a single type.
+ *
+ * @details Objects are allocated from slabs of consecutive slots, so objects created one after another are stored
+ * next to each other. Freed slots are reused before a new slab is allocated.
+ *
+ * @tparam T Object type.
+ * @tparam SlabSize Number of objects in a slab.
+ */
+template <typename T, std::size_t SlabSize = 256> class object_pool {
+public:
+    object_pool() = default;
+
+    object_pool(const object_pool&)            = delete;
+    object_pool(object_pool&&)                 = delete;
+    object_pool& operator=(const object_pool&) = delete;
+    object_pool& operator=(object_pool&&)      = delete;
+
+    ~object_pool() = default;
+
+    /**
+     * @brief Constructs an object in the pool.
+     *
+     * @param args Constructor arguments.
+     *
+     * @return Pointer to the object.
+     */
+    template <typename... Args> T* create(Args&&... args) {
+        slot_t* slot = allocate();
+        return ::new (static_cast<void*>(slot->storage)) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Destroys an object and returns its slot to the pool.
+     *
+     * @param obj Object created by this pool.
+     */
+    void destroy(T* obj) {
+        std::destroy_at(obj);
+
+        auto* slot = reinterpret_cast<slot_t*>(obj);
+        slot->next = m_free;
+        m_free     = slot;
+    }
+
+    /**
+     * @brief Frees all slabs at once.
+     *
+     * @details Objects are not destroyed, the caller must destroy them beforehand.
+     */
+    void release() {
+        m_slabs.clear();
+        m_free = nullptr;
+        m_used = SlabSize;
+    }
+
+private:
+    union slot_t {
+        slot_t* next;
+        alignas(T) std::byte storage[sizeof(T)]; // NOLINT(modernize-avoid-c-arrays)
+    };
+
+    // NOLINTNEXTLINE(modernize-avoid-c-arrays)
+    std::vector<std::unique_ptr<slot_t[]>> m_slabs;
+
+    slot_t* m_free = nullptr;
+
+    // used slots of the last slab
+    std::size_t m_used = SlabSize;
+
+    slot_t* allocate() {
+        if (m_free != nullptr) {
+            slot_t* slot = m_free;
+            m_free       = slot->next;
+            return slot;
+        }
+
+        if (m_used == SlabSize) {
+            // NOLINTNEXTLINE(modernize-avoid-c-arrays)
+            m_slabs.push_back(std::make_unique_for_overwrite<slot_t[]>(SlabSize));
+            m_used = 0;
+        }
+
+        return &m_slabs.back()[m_used++];
+    }
+};
+
+}
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace utils {
+
+template <typename T> class order_tree;
+
+/**
+ * @brief Intrusive node of the order_tree.
+ *
+ * @details Copies and moves of a node are not part of any tree.
+ */
+template <typename T> class order_tree_node {
+public:
+    order_tree_node() = default;
+
+    order_tree_node(const order_tree_node& /*unused*/) { }
+
+    order_tree_node(order_tree_node&& /*unused*/) noexcept { }
+
+    order_tree_node& operator=(const order_tree_node& /*unused*/) { return *this; }
+
+    order_tree_node& operator=(order_tree_node&& /*unused*/) noexcept { return *this; }
+
+    ~order_tree_node() = default;
+
+private:
+    order_tree_node* m_parent = nullptr;
+    order_tree_node* m_left   = nullptr;
+    order_tree_node* m_right  = nullptr;
+
+    std::uint32_t m_size     = 1;
+    std::uint32_t m_priority = 0;
+
+    friend order_tree<T>;
+};
+
+/**
+ * @brief Sequence of intrusive nodes with logarithmic positional access.
+ *
+ * @details Implemented as an implicit treap. The tree does not own the nodes.
+ *
+ * @tparam T Node type, must derive from order_tree_node<T>.
+ */
+template <typename T> class order_tree {
+private:
+    using node_t = order_tree_node<T>;
+
+public:
+    /**
+     * @brief Gets number of nodes.
+     */
+    [[nodiscard]] std::size_t size() const { return size_of(m_root); }
+
+    /**
+     * @brief Checks whether the tree is empty.
+     */
+    [[nodiscard]] bool empty() const { return m_root == nullptr; }
+
+    /**
+     * @brief Inserts a node so that it ends up at the position.
+     *
+     * @param index Position of the node, at most size().
+     * @param item Node that is not part of any tree.
+     */
+    void insert(std::size_t index, T* item) {
+        assert(index <= size());
+
+        node_t* node = item;
+
+        node->m_parent   = nullptr;
+        node->m_left     = nullptr;
+        node->m_right    = nullptr;
+        node->m_size     = 1;
+        node->m_priority = next_priority();
+
+        node_t* left  = nullptr;
+        node_t* right = nullptr;
+        split(m_root, index, left, right);
+
+        set_root(merge(merge(left, node), right));
+    }
+
+    /**
+     * @brief Appends a node.
+     *
+     * @param item Node that is not part of any tree.
+     */
+    void push_back(T* item) { insert(size(), item); }
+
+    /**
+     * @brief Removes a node.
+     *
+     * @param item Node of this tree.
+     */
+    void erase(T* item) {
+        node_t* node   = item;
+        node_t* parent = node->m_parent;
+        node_t* child  = merge(node->m_left, node->m_right);
+
+        if (child != nullptr) {
+            child->m_parent = parent;
+        }
+
+        if (parent == nullptr) {
+            m_root = child;
+        } else if (parent->m_left == node) {
+            parent->m_left = child;
+        } else {
+            parent->m_right = child;
+        }
+
+        for (node_t* it = parent; it != nullptr; it = it->m_parent) {
+            it->m_size -= 1;
+        }
+
+        node->m_parent = nullptr;
+        node->m_left   = nullptr;
+        node->m_right  = nullptr;
+        node->m_size   = 1;
+    }
+
+    /**
+     * @brief Gets node at the position.
+     *
+     * @return Node or nullptr if the position is out of range.
+     */
+    T* at(std::size_t index) const {
+        node_t* node = m_root;
+
+        while (node != nullptr) {
+            std::size_t left_size = size_of(node->m_left);
+
+            if (index < left_size) {
+                node = node->m_left;
+            } else if (index == left_size) {
+                return static_cast<T*>(node);
+            } else {
+                index -= left_size + 1;
+                node   = node->m_right;
+            }
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * @brief Gets position of a node.
+     *
+     * @param item Node of this tree.
+     */
+    std::size_t index_of(const T* item) const {
+        const node_t* node = item;
+        std::size_t index  = size_of(node->m_left);
+
+        for (; node->m_parent != nullptr; node = node->m_parent) {
+            if (node->m_parent->m_right == node) {
+                index += size_of(node->m_parent->m_left) + 1;
+            }
+        }
+
+        assert(node == m_root);
+        return index;
+    }
+
+    /**
+     * @brief Forgets all nodes.
+     */
+    void clear() { m_root = nullptr; }
+
+private:
+    node_t* m_root       = nullptr;
+    std::uint32_t m_seed = 0x9E3779B9;
+
+    static std::size_t size_of(const node_t* node) { return node == nullptr ? 0 : node->m_size; }
+
+    static void update(node_t* node) { node->m_size = 1 + size_of(node->m_left) + size_of(node->m_right); }
+
+    static void set_parent(node_t* child, node_t* parent) {
+        if (child != nullptr) {
+            child->m_parent = parent;
+        }
+    }
+
+    void set_root(node_t* root) {
+        m_root = root;
+        set_parent(m_root, nullptr);
+    }
+
+    std::uint32_t next_priority() {
+        // xorshift32
+        m_seed ^= m_seed << 13;
+        m_seed ^= m_seed >> 17;
+        m_seed ^= m_seed << 5;
+        return m_seed;
+    }
+
+    // first `count` nodes go to the left tree
+    static void split(node_t* node, std::size_t count, node_t*& left, node_t*& right) {
+        if (node == nullptr) {
+            left  = nullptr;
+            right = nullptr;
+            return;
+        }
+
+        if (size_of(node->m_left) >= count) {
+            split(node->m_left, count, left, node->m_left);
+            set_parent(node->m_left, node);
+            update(node);
+
+            right = node;
+        } else {
+            split(node->m_right, count - size_of(node->m_left) - 1, node->m_right, right);
+            set_parent(node->m_right, node);
+            update(node);
+
+            left = node;
+        }
+    }
+
+    static node_t* merge(node_t* left, node_t* right) {
+        if (left == nullptr) {
+            return right;
+        }
+
+        if (right == nullptr) {
+            return left;
+        }
+
+        if (left->m_priority > right->m_priority) {
+            left->m_right = merge(left->m_right, right);
+            set_parent(left->m_right, left);
+            update(left);
+
+            return left;
+        }
+
+        right->m_left = merge(left, right->m_left);
+        set_parent(right->m_left, right);
+        update(right);
+
+        return right;
+    }
+};
+
+}
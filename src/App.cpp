@@ -2,26 +2,34 @@
 
 #include "action/Action.h"
 #include "action/Converter.h"
+#include "conflict/ConflictManager.h"
+#include "conflict/DiskCache.h"
+#include "git/MemPack.h"
 #include "git/parser.h"
 #include "git/paths.h"
+#include "git/TaskPool.h"
 #include "gui/style/StyleManager.h"
 #include "gui/widget/RebaseViewWidget.h"
 #include "gui/widget/SettingsDialog.h"
 #include "logging/Log.h"
 #include "state/CommandHistory.h"
 #include "state/State.h"
+#include "utils/debug.h"
 #include "utils/optional_uint.h"
 
 #include <cassert>
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <string>
+#include <vector>
 
 #include <git2.h>
 #include <git2/commit.h>
 #include <git2/errors.h>
 #include <git2/global.h>
+#include <git2/oid.h>
 #include <git2/repository.h>
 #include <git2/types.h>
 
@@ -33,22 +41,34 @@
 #include <QKeySequence>
 #include <QLabel>
 #include <QLayout>
-#include <QListWidget>
+#include <QListView>
 #include <QMainWindow>
 #include <QMenuBar>
 #include <QMessageBox>
 #include <qnamespace.h>
 #include <QPalette>
+#include <QStatusBar>
 #include <QString>
 #include <utility>
 
 static App* g_app = nullptr;
 
+// the cache can be disabled in the settings file
+static void open_disk_cache(git_repository* repo) {
+    QSettings settings = App::getSettings();
+
+    if (settings.value("Cache/persistent", true).toBool() && !conflict::DiskCache::get().open(repo)) {
+        LOG_WARN("Persistent cache is disabled");
+    }
+}
+
 void App::updateGraph() { g_app->m_rebase_view->updateGraph(); }
 
 void App::updateActions() { g_app->m_rebase_view->updateActions(); }
 
-void App::updateConflicts(action::Action* start) { g_app->m_rebase_view->updateConflicts(start); }
+void App::updateConflicts(action::Action* start, action::Action* converge) {
+    g_app->m_rebase_view->updateConflicts(start, converge);
+}
 
 gui::widget::RebaseViewWidget* App::getRebaseViewWidget() { return g_app->m_rebase_view; }
 
@@ -115,6 +135,13 @@ App::App() {
     App::loadShortcuts(settings);
 }
 
+App::~App() {
+    // the workers hold repositories
+    git::TaskPool::get().shutdown();
+
+    git_libgit2_shutdown();
+}
+
 void App::setupShortcuts() {
     auto create_shortcut = [this](
                                const QString& id,
@@ -132,10 +159,10 @@ void App::setupShortcuts() {
     };
 
     {
-        QListWidget* actions_list = m_rebase_view->getList();
-        auto* actions_move_up     = create_shortcut("actions.move_up", actions_list, "Move focused action up");
-        auto* actions_move_down   = create_shortcut("actions.move_down", actions_list, "Move focused action down");
-        auto* actions_change      = create_shortcut("actions.change_type", actions_list, "Change focused action type");
+        QListView* actions_list = m_rebase_view->getList();
+        auto* actions_move_up   = create_shortcut("actions.move_up", actions_list, "Move focused action up");
+        auto* actions_move_down = create_shortcut("actions.move_down", actions_list, "Move focused action down");
+        auto* actions_change    = create_shortcut("actions.change_type", actions_list, "Change focused action type");
 
         constexpr auto action_types = gui::widget::ListItem::items;
 
@@ -274,6 +301,20 @@ void App::setup() {
     m_rebase_view->hide();
     m_rebase_view->hideOldCommits();
 
+    connect(
+        m_rebase_view,
+        &gui::widget::RebaseViewWidget::matrixProgress,
+        this,
+        [this](std::uint32_t done, std::uint32_t total) {
+            if (done == total) {
+                statusBar()->clearMessage();
+                return;
+            }
+
+            statusBar()->showMessage(QString("Comparing commits %1/%2").arg(done).arg(total));
+        }
+    );
+
     connect(m_welcome_widget, &gui::widget::WelcomeWidget::openCurrentDirectory, this, [this]() {
         QString currentPath = QDir::currentPath();
 
@@ -361,6 +402,10 @@ void App::closeEvent(QCloseEvent* event) {
         event->ignore();
         break;
     }
+
+    if (event->isAccepted()) {
+        conflict::DiskCache::get().close();
+    }
 }
 
 void App::hideOldCommits(bool state) {
@@ -431,9 +476,23 @@ bool App::openRepo(const std::string& path) {
         return false;
     }
 
+    // the cached objects are written to the previous repository
+    conflict::DiskCache::get().close();
+
     m_repo      = std::move(new_repo);
     m_repo_path = path;
 
+    if (!git::MemPack::get().attach(m_repo)) {
+        utils::log_libgit_error();
+    }
+
+    // the workers share the object database with the in-memory objects
+    if (!git::TaskPool::get().attach(m_repo)) {
+        utils::log_libgit_error();
+    }
+
+    open_disk_cache(m_repo);
+
     if (!loadRebase()) {
         m_welcome_widget->show();
         return false;
@@ -502,6 +561,29 @@ bool App::saveSaveFile(bool choose_file) {
 
     LOG_INFO("Saving: {}", m_save_file->toStdString());
 
+    // objects referenced by the save file
+    std::vector<git_oid> objects;
+    for (auto& act : action::ActionsManager::get()) {
+        objects.push_back(act.get_oid());
+    }
+
+    auto& conflict_manager = conflict::ConflictManager::get();
+    for (auto&& [entry, id] : conflict_manager.get_conflicts()) {
+        if (git_oid_is_zero(&id) == 0) {
+            objects.push_back(id);
+        }
+    }
+
+    for (auto&& [conflict, tree] : conflict_manager.get_tree_conflicts()) {
+        objects.push_back(*git_tree_id(tree.get()));
+    }
+
+    if (!git::MemPack::get().flush(objects)) {
+        utils::log_libgit_error();
+        QMessageBox::critical(this, "Save error", "Failed to write objects");
+        return false;
+    }
+
     if (!state::State::save(m_save_file.value().toStdU32String(), m_repo_path, m_rebase_head, m_rebase_onto)) {
         QMessageBox::critical(this, "Save error", "Failed to save");
         return false;
@@ -533,9 +615,22 @@ bool App::loadSaveFile() {
 
     m_rebase_view->hide();
 
+    conflict::DiskCache::get().close();
+
     m_save_file = filepath;
     m_repo      = std::move(repo);
 
+    if (!git::MemPack::get().attach(m_repo)) {
+        utils::log_libgit_error();
+    }
+
+    // the workers share the object database with the in-memory objects
+    if (!git::TaskPool::get().attach(m_repo)) {
+        utils::log_libgit_error();
+    }
+
+    open_disk_cache(m_repo);
+
     m_rebase_head = save_data->head;
     m_rebase_onto = save_data->onto;
 
@@ -623,14 +718,23 @@ bool App::saveTodoFile(bool insert_break) {
 
     LOG_INFO("Saving todo file: {}", filepath);
 
+    std::vector<git_oid> commits;
+
     auto& manager = action::ActionsManager::get();
-    bool status
-        = action::Converter::actions_to_todo(todo_file, manager, conflict::ConflictManager::get(), insert_break);
+    bool status   = action::Converter::actions_to_todo(
+        todo_file, manager, conflict::ConflictManager::get(), insert_break, &commits
+    );
 
     if (!status) {
         QMessageBox::critical(this, "Save Error", "Failed to save rebase instructions.");
         return false;
     }
 
+    if (!git::MemPack::get().flush(commits)) {
+        utils::log_libgit_error();
+        QMessageBox::critical(this, "Save Error", "Failed to write commits used by the rebase instructions.");
+        return false;
+    }
+
     return true;
 }
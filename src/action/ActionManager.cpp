@@ -1,16 +1,20 @@
 #include "action/ActionManager.h"
 
 #include "action/Action.h"
+#include "action/PlanSnapshot.h"
+#include "conflict/ConflictManager.h"
 #include "git/types.h"
-#include "utils/unexpected.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <git2/commit.h>
 #include <git2/oid.h>
 #include <git2/types.h>
 
@@ -34,13 +38,20 @@ git::commit_t ActionsManager::split(Action* act, git::commit_t&& prev, git::comm
 
     act->m_commit = std::move(prev);
 
-    auto* tmp = new Action(act->get_type(), std::move(next));
+    auto* tmp = m_pool.create(act->get_type(), std::move(next));
 
     auto* next_act = act->get_next();
 
     tmp->set_next_connection(next_act);
     tmp->set_prev_connection(act);
 
+    m_order.insert(m_order.index_of(act) + 1, tmp);
+
+    if (m_tail == act) {
+        m_tail = tmp;
+    }
+
+    changed(m_order.index_of(act));
     return commit;
 }
 
@@ -52,10 +63,16 @@ std::pair<git::commit_t, git::commit_t> ActionsManager::merge_next(Action* act,
     auto commits = std::make_pair<git::commit_t, git::commit_t>(std::move(act->m_commit), std::move(next->m_commit));
 
     act->m_commit = std::move(commit);
+    changed(m_order.index_of(act));
 
     act->set_next_connection(next->get_next());
 
-    delete next;
+    if (m_tail == next) {
+        m_tail = act;
+    }
+
+    m_order.erase(next);
+    m_pool.destroy(next);
 
     return commits;
 }
@@ -65,96 +82,48 @@ Action* ActionsManager::move(std::uint32_t from, std::uint32_t to) {
         return m_tail;
     }
 
-    auto* from_ptr = get_action(from);
-    auto* to_ptr   = get_action(to);
-
-    auto* from_prev = from_ptr->get_prev();
-    auto* from_next = from_ptr->get_next();
-
-    auto* to_prev = to_ptr->get_prev();
-    auto* to_next = to_ptr->get_next();
-
-    if (from + 1 == to) {
-        // to <-> from
-        from_ptr->set_prev_connection(to_ptr);
-
-        // from <-> next
-        from_ptr->set_next_connection(to_next);
-
-        // prev <-> to
-        to_ptr->set_prev_connection(from_prev);
+    auto* act = m_order.at(from);
+    assert(act != nullptr && to < m_order.size());
 
-        if (m_tail == to_ptr) {
-            m_tail = from_ptr;
-        }
-
-        if (m_head == from_ptr) {
-            m_head = to_ptr;
-        }
-
-        return from_prev;
-
-    } else if (from == to + 1) {
-        // prev <-> from
-        from_ptr->set_prev_connection(to_prev);
-
-        // from <-> to
-        from_ptr->set_next_connection(to_ptr);
-
-        // to <-> next
-        to_ptr->set_next_connection(from_next);
-
-        if (m_tail == from_ptr) {
-            m_tail = to_ptr;
-        }
-
-        if (m_head == to_ptr) {
-            m_head = from_ptr;
-        }
-
-        return to_prev;
-
-    } else if (to < from) {
-        // from <-> to
-        from_ptr->set_next_connection(to_ptr);
-
-        // prev <-> from
-        from_ptr->set_prev_connection(to_prev);
-
-        from_prev->set_next_connection(from_next);
-
-        if (m_tail == from_ptr) {
-            m_tail = from_prev;
-        }
-
-        if (m_head == to_ptr) {
-            m_head = from_ptr;
-        }
+    // prev <-> next
+    auto* prev = act->get_prev();
+    auto* next = act->get_next();
 
-        return to_prev;
+    if (prev != nullptr) {
+        prev->set_next(next);
+    } else {
+        m_head = next;
+    }
 
-    } else if (to > from) {
-        // to <-> from
-        from_ptr->set_prev_connection(to_ptr);
+    if (next != nullptr) {
+        next->set_prev(prev);
+    } else {
+        m_tail = prev;
+    }
 
-        // from <-> next
-        from_ptr->set_next_connection(to_next);
+    m_order.erase(act);
+    m_order.insert(to, act);
 
-        from_next->set_prev_connection(from_prev);
+    // new_prev <-> act <-> new_next
+    auto* new_prev = (to == 0) ? nullptr : m_order.at(to - 1);
+    auto* new_next = m_order.at(to + 1);
 
-        if (m_tail == to_ptr) {
-            m_tail = from_ptr;
-        }
+    act->set_prev_connection(new_prev);
+    act->set_next_connection(new_next);
 
-        if (m_head == from_ptr) {
-            m_head = from_next;
-        }
+    if (new_prev == nullptr) {
+        m_head = act;
+    }
 
-        return from_prev;
+    if (new_next == nullptr) {
+        m_tail = act;
     }
 
-    // unreachable
-    UNEXPECTED();
+    // the last action that was not affected
+    std::uint32_t first = std::min(from, to);
+    changed(first);
+
+    return (first == 0) ? nullptr : m_order.at(first - 1);
 }
 
 void ActionsManager::clear() {
@@ -162,22 +131,26 @@ void ActionsManager::clear() {
         auto* p = ptr;
         ptr     = ptr->get_next();
 
-        delete p;
+        std::destroy_at(p);
     }
 
+    // free all actions at once
+    m_pool.release();
+
     m_msg.clear();
+    m_order.clear();
     m_head = nullptr;
     m_tail = nullptr;
+
+    changed(0);
 }
 
 [[nodiscard]] std::size_t ActionsManager::get_index(const_iterator_t iter) const {
-    std::size_t i = 0;
-
-    for (auto it = cbegin(); it != iter; ++it) {
-        i += 1;
+    if (iter == cend()) {
+        return m_order.size();
     }
 
-    return i;
+    return m_order.index_of(&*iter);
 }
 
 git_commit* ActionsManager::get_parent_commit(Action* act) {
@@ -217,24 +190,93 @@ Action* ActionsManager::get_picked_parent(Action* act) {
     return nullptr;
 }
 
-Action* ActionsManager::get_action(std::uint32_t index) {
-    auto* act = m_head;
+Action* ActionsManager::get_action(std::uint32_t index) { return m_order.at(index); }
 
-    for (std::uint32_t i = 0; i < index && act != nullptr; ++i) {
-        act = act->get_next();
+std::uint32_t ActionsManager::get_action_index(Action* find) {
+    if (find == nullptr) {
+        return m_order.size();
     }
 
-    return act;
+    return m_order.index_of(find);
 }
 
-std::uint32_t ActionsManager::get_action_index(Action* find) {
-    auto* act           = m_head;
-    std::uint32_t index = 0;
+std::shared_ptr<const PlanSnapshot> ActionsManager::snapshot() {
+    auto resolutions = conflict::ConflictManager::get().snapshot();
 
-    for (; act != find && act != nullptr; ++index) {
-        act = act->get_next();
+    if (m_snapshot != nullptr && m_snapshot->m_version == m_version && m_snapshot->m_resolutions == resolutions) {
+        return m_snapshot;
     }
 
-    return index;
+    std::vector<std::shared_ptr<const PlanSnapshot::chunk_t>> chunks;
+    chunks.reserve((size() + PlanSnapshot::CHUNK_SIZE - 1) / PlanSnapshot::CHUNK_SIZE);
+
+    // the chunks before the first changed action are shared
+    std::size_t first = std::min<std::size_t>(m_changed_from, size()) / PlanSnapshot::CHUNK_SIZE;
+    if (m_snapshot != nullptr) {
+        first = std::min(first, m_snapshot->m_chunks.size());
+        chunks.assign(m_snapshot->m_chunks.begin(), m_snapshot->m_chunks.begin() + static_cast<std::ptrdiff_t>(first));
+    } else {
+        first = 0;
+    }
+
+    const Action* act = m_order.at(first * PlanSnapshot::CHUNK_SIZE);
+    while (act != nullptr) {
+        auto chunk = std::make_shared<PlanSnapshot::chunk_t>();
+        chunk->reserve(PlanSnapshot::CHUNK_SIZE);
+
+        for (; act != nullptr && chunk->size() < PlanSnapshot::CHUNK_SIZE; act = act->get_next()) {
+            chunk->push_back({ .commit = act->get_oid(), .type = act->get_type() });
+        }
+
+        chunks.push_back(std::move(chunk));
+    }
+
+    git_oid root_commit = {};
+    if (m_root_commit != nullptr) {
+        git_oid_cpy(&root_commit, git_commit_id(m_root_commit));
+    }
+
+    m_snapshot = std::make_shared<const PlanSnapshot>(
+        m_version, root_commit, std::move(chunks), size(), std::move(resolutions)
+    );
+    m_changed_from = size();
+
+    return m_snapshot;
+}
+
+bool ActionsManager::is_current(const PlanSnapshot& snapshot, std::size_t prefix) {
+    // NOTE: The resolutions are copied only after a change, so the same copy means no change
+    if (snapshot.m_resolutions != conflict::ConflictManager::get().snapshot()) {
+        return false;
+    }
+
+    if (snapshot.m_version == m_version) {
+        return true;
+    }
+
+    if (prefix > size() || prefix > snapshot.size()) {
+        return false;
+    }
+
+    git_oid root_commit = {};
+    if (m_root_commit != nullptr) {
+        git_oid_cpy(&root_commit, git_commit_id(m_root_commit));
+    }
+
+    if (git_oid_equal(&root_commit, &snapshot.m_root_commit) == 0) {
+        return false;
+    }
+
+    const Action* act = m_head;
+    for (std::size_t i = 0; i < prefix; ++i, act = act->get_next()) {
+        const SnapshotAction current { .commit = act->get_oid(), .type = act->get_type() };
+
+        if (snapshot.at(i) != current) {
+            return false;
+        }
+    }
+
+    return true;
 }
+
 }
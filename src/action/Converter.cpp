@@ -18,11 +18,13 @@
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace action {
 
 struct ActionInfo {
     std::array<char, 256> buff;
+    git_oid id;
     std::string oid;
     std::string msg;
     std::istringstream new_msg;
@@ -78,11 +80,13 @@ std::pair<ActionInfo, bool> get_action_info(
             return std::make_pair<ActionInfo, bool>(std::move(info), false);
         }
 
-        info.oid = git_oid_tostr_s(&oid);
+        info.id = oid;
     } else {
-        info.oid = git_oid_tostr_s(git_commit_id(commit));
+        info.id = *git_commit_id(commit);
     }
 
+    info.oid = git_oid_tostr_s(&info.id);
+
     if (act.has_msg()) {
         auto msg_id      = act.get_msg_id().value();
         std::string& msg = manager.get_msg(msg_id);
@@ -126,7 +130,11 @@ void fixup_to_todo(std::ostream& output, ActionInfo& info) {
 }
 
 bool Converter::actions_to_todo(
-    std::ostream& output, ActionsManager& manager, conflict::ConflictManager& conflict_manager, bool insert_break
+    std::ostream& output,
+    ActionsManager& manager,
+    conflict::ConflictManager& conflict_manager,
+    bool insert_break,
+    std::vector<git_oid>* commits
 ) {
     ConverterContext ctx;
     ctx.root = manager.get_root_commit();
@@ -149,6 +157,10 @@ bool Converter::actions_to_todo(
             return false;
         }
 
+        if (commits != nullptr) {
+            commits->push_back(info.id);
+        }
+
         switch (act.get_type()) {
         case ActionType::PICK:
             pick_to_todo(output, info);
@@ -0,0 +1,477 @@
+#include "conflict/CommuteMatrix.h"
+
+#include "action/Action.h"
+#include "action/ActionManager.h"
+#include "git/diff.h"
+#include "git/TaskPool.h"
+#include "git/types.h"
+#include "logging/Log.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <git2/commit.h>
+#include <git2/diff.h>
+#include <git2/oid.h>
+#include <git2/tree.h>
+#include <git2/types.h>
+
+namespace conflict {
+
+// NOTE: Hunks without lines start after the line, converts them to an empty interval before the next line
+static std::pair<int, int> to_interval(const git::hunk_lines_info& lines) {
+    if (lines.count == 0) {
+        return { lines.offset, lines.offset };
+    }
+
+    return { lines.offset - 1, lines.offset - 1 + lines.count };
+}
+
+static bool collect_files(git_repository* repo, const git_oid& commit_id, TouchedCommit& touched) {
+    git::commit_t commit;
+    git::commit_t parent;
+    git::tree_t tree;
+    git::tree_t parent_tree;
+
+    if (git_commit_lookup(&commit, repo, &commit_id) != 0 || git_commit_tree(&tree, commit) != 0) {
+        return false;
+    }
+
+    // root commits are diffed against an empty tree
+    touched.has_parent = git_commit_parentcount(commit) > 0;
+    if (touched.has_parent) {
+        if (git_commit_parent(&parent, commit, 0) != 0 || git_commit_tree(&parent_tree, parent) != 0) {
+            return false;
+        }
+
+        git_oid_cpy(&touched.parent, git_commit_id(parent));
+    }
+
+    // the hunks contain only the changed lines
+    git_diff_options opts = GIT_DIFF_OPTIONS_INIT;
+    opts.context_lines    = 0;
+
+    git::diff_t diff;
+    if (git_diff_tree_to_tree(&diff, repo, parent_tree, tree, &opts) != 0) {
+        return false;
+    }
+
+    auto created = git::create_diff(std::move(diff));
+    if (!created.has_value()) {
+        return false;
+    }
+
+    git::diff_model_t& model = created.value();
+    touched.files.reserve(model.files.size());
+
+    for (std::size_t i = 0; i < model.files.size(); ++i) {
+        const bool loaded             = git::load_diff_file(model, i);
+        const git::diff_files_t& file = model.files[i];
+
+        TouchedFile& entry = touched.files.emplace_back();
+        entry.path            = file.new_file.path;
+
+        // binary files have no hunks
+        const bool binary = file.hunks.empty() && git_oid_equal(&file.old_file.id, &file.new_file.id) == 0;
+        entry.whole       = !loaded || binary || file.state != git::diff_files_t::State::MODIFIED;
+
+        entry.ranges.reserve(file.hunks.size());
+
+        for (auto&& hunk : file.hunks) {
+            auto [old_begin, old_end] = to_interval(hunk.old_file);
+            auto [new_begin, new_end] = to_interval(hunk.new_file);
+
+            entry.ranges.push_back({
+                .old_begin = old_begin,
+                .old_end   = old_end,
+                .new_begin = new_begin,
+                .new_end   = new_end,
+            });
+        }
+
+        // the old path of a moved file is changed as a whole
+        if (file.old_file.path != file.new_file.path) {
+            TouchedFile& old_entry = touched.files.emplace_back();
+            old_entry.path            = file.old_file.path;
+            old_entry.whole           = true;
+        }
+    }
+
+    return true;
+}
+
+// NOTE: Positions inside a changed range are moved to its boundary, the interval can only grow
+static int shift_line(int line, std::span<const LineRange> ranges, bool begin) {
+    int delta = 0;
+
+    for (auto&& range : ranges) {
+        if (line < range.old_begin) {
+            break;
+        }
+
+        if (line <= range.old_end) {
+            return begin ? range.new_begin : range.new_end;
+        }
+
+        delta += (range.new_end - range.new_begin) - (range.old_end - range.old_begin);
+    }
+
+    return line + delta;
+}
+
+// NOTE: Adjacent changes conflict as well
+static bool touches(int begin_a, int end_a, int begin_b, int end_b) { return begin_a <= end_b && begin_b <= end_a; }
+
+static bool intersects(const std::vector<std::uint32_t>& a, const std::vector<std::uint32_t>& b) {
+    auto it_a = a.begin();
+    auto it_b = b.begin();
+
+    while (it_a != a.end() && it_b != b.end()) {
+        if (*it_a == *it_b) {
+            return true;
+        }
+
+        if (*it_a < *it_b) {
+            ++it_a;
+        } else {
+            ++it_b;
+        }
+    }
+
+    return false;
+}
+
+static void sort_unique(std::vector<std::uint32_t>& ids) {
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+}
+
+std::vector<git_oid> CommuteMatrix::missing(const action::ActionsManager& actions) const {
+    std::vector<git_oid> commits;
+    std::unordered_set<git_oid, git::oid_hash, git::oid_equal> seen;
+
+    for (auto&& act : actions) {
+        const git_oid& oid = act.get_oid();
+
+        if (!m_index.contains(oid) && seen.insert(oid).second) {
+            commits.push_back(oid);
+        }
+    }
+
+    return commits;
+}
+
+std::optional<std::vector<TouchedCommit>>
+CommuteMatrix::collect(git_repository* repo, std::span<const git_oid> commits, git::TaskToken& token) {
+    std::vector<TouchedCommit> touched(commits.size());
+
+    // NOTE: Commits are pulled one by one, the sizes of commits differ a lot
+    const bool collected = git::TaskPool::get().run_batch(
+        repo,
+        commits.size(),
+        [&](git_repository* thread_repo, std::size_t i) {
+            touched[i].commit = commits[i];
+            return collect_files(thread_repo, commits[i], touched[i]);
+        },
+        git::TaskPriority::LOW,
+        &token
+    );
+
+    if (!collected) {
+        return std::nullopt;
+    }
+
+    return touched;
+}
+
+void CommuteMatrix::add(std::vector<TouchedCommit>&& commits) {
+    const std::size_t first = m_sets.size();
+
+    for (auto&& touched : commits) {
+        // the plan may contain a commit twice or it was added by a previous result
+        if (m_index.contains(touched.commit)) {
+            continue;
+        }
+
+        const std::size_t index = m_sets.size();
+
+        path_set_t set;
+        set.files.reserve(touched.files.size());
+        set.lines.reserve(touched.files.size());
+
+        for (auto&& file : touched.files) {
+            const std::uint32_t id = intern(file.path);
+
+            set.files.push_back(id);
+            set.lines.push_back({ .path = id, .whole = file.whole, .ranges = std::move(file.ranges) });
+
+            for (std::size_t end = file.path.find('/'); end != std::string::npos; end = file.path.find('/', end + 1)) {
+                set.dirs.push_back(intern(file.path.substr(0, end)));
+            }
+        }
+
+        sort_unique(set.files);
+        sort_unique(set.dirs);
+
+        std::sort(set.lines.begin(), set.lines.end(), [](const file_lines_t& a, const file_lines_t& b) {
+            return a.path < b.path;
+        });
+
+        // the commit continues the series of the previous one
+        auto parent = touched.has_parent ? m_index.find(touched.parent) : m_index.end();
+
+        if (parent != m_index.end() && parent->second + 1 == index) {
+            set.series   = m_sets.back().series;
+            set.position = m_sets.back().position + 1;
+        } else {
+            set.series   = m_series++;
+            set.position = 0;
+        }
+
+        for (auto&& id : set.files) {
+            m_touched_by[id].push_back(index);
+        }
+
+        m_index.emplace(touched.commit, index);
+        m_sets.push_back(std::move(set));
+    }
+
+    if (m_sets.size() == first) {
+        return;
+    }
+
+    extend_matrix(first);
+
+    LOG_INFO("Computed paths of {} commits, {} unique paths", m_sets.size() - first, m_path_ids.size());
+}
+
+void CommuteMatrix::extend_matrix(std::size_t first) {
+    const std::size_t count  = m_sets.size();
+    const std::size_t stride = (count + WORD_BITS - 1) / WORD_BITS;
+
+    // the rows of the known commits keep their bits
+    if (stride != m_stride) {
+        std::vector<std::uint64_t> matrix(count * stride, 0);
+        std::vector<std::uint64_t> conflicts(count * stride, 0);
+
+        for (std::size_t row = 0; row < first; ++row) {
+            const auto from = static_cast<std::ptrdiff_t>(row * m_stride);
+            const auto to   = static_cast<std::ptrdiff_t>(row * stride);
+
+            std::copy_n(m_matrix.begin() + from, m_stride, matrix.begin() + to);
+            std::copy_n(m_conflicts.begin() + from, m_stride, conflicts.begin() + to);
+        }
+
+        m_matrix    = std::move(matrix);
+        m_conflicts = std::move(conflicts);
+        m_stride    = stride;
+    } else {
+        m_matrix.resize(count * stride, 0);
+        m_conflicts.resize(count * stride, 0);
+    }
+
+    // every task fills a whole new row
+    git::TaskPool::get().run_batch(nullptr, count - first, [&](git_repository*, std::size_t i) {
+        const std::size_t row    = first + i;
+        const path_set_t& a      = m_sets[row];
+        std::uint64_t* overlaps  = &m_matrix[row * m_stride];
+        std::uint64_t* conflicts = &m_conflicts[row * m_stride];
+
+        for (std::size_t col = 0; col < count; ++col) {
+            const path_set_t& b     = m_sets[col];
+            const std::uint64_t bit = std::uint64_t(1) << (col % WORD_BITS);
+
+            // a file replaced by a directory is an overlap as well
+            const bool dir_overlap = intersects(a.files, b.dirs) || intersects(a.dirs, b.files);
+
+            if (!dir_overlap && !intersects(a.files, b.files)) {
+                continue;
+            }
+
+            overlaps[col / WORD_BITS] |= bit;
+
+            if (dir_overlap || row == col || lines_conflict(row, col)) {
+                conflicts[col / WORD_BITS] |= bit;
+            }
+        }
+
+        return true;
+    });
+
+    // NOTE: The matrices are symmetric, the new columns of the known rows are copied from the new rows
+    for (std::size_t row = first; row < count; ++row) {
+        const std::uint64_t bit = std::uint64_t(1) << (row % WORD_BITS);
+
+        for (std::size_t col = 0; col < first; ++col) {
+            if (overlaps(row, col)) {
+                m_matrix[col * m_stride + row / WORD_BITS] |= bit;
+            }
+
+            if (may_conflict(row, col)) {
+                m_conflicts[col * m_stride + row / WORD_BITS] |= bit;
+            }
+        }
+    }
+}
+
+bool CommuteMatrix::lines_conflict(std::size_t a, std::size_t b) const {
+    // the intervals of the later commit are in the coordinates after the earlier one
+    if (m_sets[a].series != m_sets[b].series) {
+        return true;
+    }
+
+    if (m_sets[a].position > m_sets[b].position) {
+        std::swap(a, b);
+    }
+
+    const auto& files_a = m_sets[a].files;
+    const auto& files_b = m_sets[b].files;
+
+    auto it_a = files_a.begin();
+    auto it_b = files_b.begin();
+
+    while (it_a != files_a.end() && it_b != files_b.end()) {
+        if (*it_a < *it_b) {
+            ++it_a;
+        } else if (*it_b < *it_a) {
+            ++it_b;
+        } else {
+            if (file_conflicts(a, b, *it_a)) {
+                return true;
+            }
+
+            ++it_a;
+            ++it_b;
+        }
+    }
+
+    return false;
+}
+
+bool CommuteMatrix::may_conflict(std::size_t a, std::size_t b, const std::string& path) const {
+    auto it = m_path_ids.find(path);
+    if (it == m_path_ids.end()) {
+        return false;
+    }
+
+    const std::uint32_t id = it->second;
+
+    if (!std::binary_search(m_sets[a].files.begin(), m_sets[a].files.end(), id)
+        || !std::binary_search(m_sets[b].files.begin(), m_sets[b].files.end(), id)) {
+        return false;
+    }
+
+    // the intervals of the later commit are in the coordinates after the earlier one
+    if (m_sets[a].series != m_sets[b].series) {
+        return true;
+    }
+
+    if (m_sets[a].position > m_sets[b].position) {
+        std::swap(a, b);
+    }
+
+    return file_conflicts(a, b, id);
+}
+
+static const auto* find_lines(const auto& lines, std::uint32_t path) {
+    auto it = std::lower_bound(lines.begin(), lines.end(), path, [](const auto& file, std::uint32_t id) {
+        return file.path < id;
+    });
+
+    assert(it != lines.end() && it->path == path);
+    return &*it;
+}
+
+bool CommuteMatrix::file_conflicts(std::size_t a, std::size_t b, std::uint32_t path) const {
+    const file_lines_t* lines_a = find_lines(m_sets[a].lines, path);
+    const file_lines_t* lines_b = find_lines(m_sets[b].lines, path);
+
+    if (lines_a->whole || lines_b->whole) {
+        return true;
+    }
+
+    std::vector<std::pair<int, int>> intervals;
+    intervals.reserve(lines_a->ranges.size());
+
+    for (auto&& range : lines_a->ranges) {
+        intervals.emplace_back(range.new_begin, range.new_end);
+    }
+
+    // shift through the commits in between
+    for (std::size_t index : m_touched_by.at(path)) {
+        const path_set_t& set = m_sets[index];
+
+        if (set.series != m_sets[a].series || set.position <= m_sets[a].position
+            || set.position >= m_sets[b].position) {
+            continue;
+        }
+
+        const file_lines_t* lines = find_lines(set.lines, path);
+        if (lines->whole) {
+            return true;
+        }
+
+        for (auto& [begin, end] : intervals) {
+            begin = shift_line(begin, lines->ranges, true);
+            end   = shift_line(end, lines->ranges, false);
+        }
+    }
+
+    for (auto&& range : lines_b->ranges) {
+        for (auto&& [begin, end] : intervals) {
+            if (touches(begin, end, range.old_begin, range.old_end)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+std::optional<std::size_t> CommuteMatrix::index_of(const git_oid& commit) const {
+    auto it = m_index.find(commit);
+    if (it == m_index.end()) {
+        return std::nullopt;
+    }
+
+    return it->second;
+}
+
+bool CommuteMatrix::can_commute(const git_oid& a, const git_oid& b) const {
+    auto index_a = index_of(a);
+    auto index_b = index_of(b);
+
+    if (!index_a.has_value() || !index_b.has_value()) {
+        return false;
+    }
+
+    return !may_conflict(*index_a, *index_b);
+}
+
+std::uint32_t CommuteMatrix::intern(const std::string& path) {
+    auto it = m_path_ids.try_emplace(path, static_cast<std::uint32_t>(m_path_ids.size())).first;
+    return it->second;
+}
+
+void CommuteMatrix::clear() {
+    m_index.clear();
+    m_path_ids.clear();
+    m_sets.clear();
+    m_touched_by.clear();
+    m_series = 0;
+    m_matrix.clear();
+    m_conflicts.clear();
+    m_stride = 0;
+}
+
+}
@@ -1,6 +1,7 @@
 #include "conflict/ConflictManager.h"
 
 #include "conflict/conflict_iterator.h"
+#include "conflict/DiskCache.h"
 #include "git/types.h"
 
 #include <cassert>
@@ -8,6 +9,7 @@
 #include <cstdint>
 #include <cstring>
 #include <ctime>
+#include <memory>
 #include <span>
 #include <string>
 #include <utility>
@@ -29,21 +31,35 @@ bool ConflictManager::is_resolved(
     ConflictEntry entry;
 
     if (ancestor != nullptr) {
-        entry.ancestor_id = git_oid_tostr_s(&ancestor->id);
+        git_oid_cpy(&entry.ancestor_id, &ancestor->id);
     }
 
     if (their != nullptr) {
-        entry.their_id = git_oid_tostr_s(&their->id);
+        git_oid_cpy(&entry.their_id, &their->id);
     }
 
     if (our != nullptr) {
-        entry.our_id = git_oid_tostr_s(&our->id);
+        git_oid_cpy(&entry.our_id, &our->id);
     }
 
     return is_resolved(entry);
 }
 
-bool ConflictManager::is_resolved(const ConflictEntry& entry) { return m_conflicts.contains(entry); }
+bool ConflictManager::is_resolved(const ConflictEntry& entry) {
+    if (m_conflicts.contains(entry)) {
+        return true;
+    }
+
+    // the same conflict was resolved in a previous session
+    auto stored = DiskCache::get().find_resolution(entry);
+    if (!stored.has_value()) {
+        return false;
+    }
+
+    m_conflicts.insert_or_assign(entry, *stored);
+    m_snapshot = nullptr;
+    return true;
+}
 
 bool ConflictManager::is_resolved(git::index_t& index) {
     if (git_index_has_conflicts(index.get()) == 0) {
@@ -90,14 +106,22 @@ bool ConflictManager::apply_resolutions_no_write(
 bool ConflictManager::apply_resolution(
     const std::string& path, const ConflictEntry& entry, git_repository* repo, git_index* index
 ) {
-    auto it = m_conflicts.find(entry);
+    return apply_resolution(m_conflicts, path, entry, repo, index);
+}
 
-    if (it == m_conflicts.end()) {
+bool ConflictManager::apply_resolution(
+    const resolutions_t& resolutions,
+    const std::string& path,
+    const ConflictEntry& entry,
+    git_repository* repo,
+    git_index* index
+) {
+    const git_oid* resolution_id = resolutions.find(entry);
+
+    if (resolution_id == nullptr) {
         return true;
     }
 
-    const std::string& resolution_id = it->second;
-
     const git_index_entry* ancestor = nullptr;
     const git_index_entry* our      = nullptr;
     const git_index_entry* their    = nullptr;
@@ -115,17 +139,12 @@ bool ConflictManager::apply_resolution(
     }
 
     // The file is deleted
-    if (resolution_id.empty()) {
+    if (git_oid_is_zero(resolution_id) != 0) {
         return true;
     }
 
-    git_oid oid;
-    if (git_oid_fromstr(&oid, resolution_id.c_str()) != 0) {
-        return false;
-    }
-
     git::blob_t blob;
-    if (git_blob_lookup(&blob, repo, &oid) != 0) {
+    if (git_blob_lookup(&blob, repo, resolution_id) != 0) {
         return false;
     }
 
@@ -134,7 +153,7 @@ bool ConflictManager::apply_resolution(
     git_index_entry new_entry;
     std::memset(&new_entry, 0, sizeof(git_index_entry));
 
-    git_oid_cpy(&new_entry.id, &oid);
+    git_oid_cpy(&new_entry.id, resolution_id);
     new_entry.path           = path.c_str();
     new_entry.file_size      = content_size;
     new_entry.flags          = 0;
@@ -182,28 +201,47 @@ bool ConflictManager::apply_resolution(
     return true;
 }
 
-void ConflictManager::add_resolution(const ConflictEntry& entry, std::string id) { m_conflicts[entry] = id; }
+void ConflictManager::add_resolution(const ConflictEntry& entry, const git_oid& id) {
+    m_conflicts.insert_or_assign(entry, id);
+    m_snapshot = nullptr;
+
+    DiskCache::get().insert_resolution(entry, id);
+}
 
 void ConflictManager::add_trees_resolution(const ConflictTrees& conflict, git::tree_t&& resolution) {
-    m_trees[conflict] = std::move(resolution);
+    m_trees.insert_or_assign(conflict, std::move(resolution));
+    m_snapshot = nullptr;
+}
+
+std::shared_ptr<const ResolutionsSnapshot> ConflictManager::snapshot() {
+    if (m_snapshot != nullptr) {
+        return m_snapshot;
+    }
+
+    auto snapshot       = std::make_shared<ResolutionsSnapshot>();
+    snapshot->conflicts = m_conflicts;
+
+    snapshot->trees.reserve(m_trees.size());
+    for (auto&& [conflict, tree] : m_trees) {
+        snapshot->trees.insert_or_assign(conflict, *git_tree_id(tree.get()));
+    }
+
+    m_snapshot = std::move(snapshot);
+    return m_snapshot;
 }
 
 git_tree* ConflictManager::get_trees_resolution(const git_tree* old_tree, const git_commit* new_commit) {
     ConflictTrees conflict;
 
-    conflict.parent_tree_id = git::format_oid_to_str<git::OID_SIZE>(git_tree_id(old_tree));
-    conflict.commit_id      = git::format_oid_to_str<git::OID_SIZE>(git_commit_id(new_commit));
+    git_oid_cpy(&conflict.parent_tree_id, git_tree_id(old_tree));
+    git_oid_cpy(&conflict.commit_id, git_commit_id(new_commit));
 
     return get_trees_resolution(conflict);
 }
 
 git_tree* ConflictManager::get_trees_resolution(const ConflictTrees& conflict) {
-    auto it = m_trees.find(conflict);
-    if (it != m_trees.end()) {
-        return it->second.get();
-    }
-
-    return nullptr;
+    git::tree_t* tree = m_trees.find(conflict);
+    return (tree != nullptr) ? tree->get() : nullptr;
 }
 
 }
@@ -0,0 +1,396 @@
+#include "conflict/DiskCache.h"
+
+#include "action/Action.h"
+#include "build.h"
+#include "conflict/conflict.h"
+#include "conflict/ConflictManager.h"
+#include "conflict/MergeCache.h"
+#include "git/MemPack.h"
+#include "logging/Log.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <ios>
+#include <optional>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <git2/odb.h>
+#include <git2/oid.h>
+#include <git2/repository.h>
+#include <git2/types.h>
+
+namespace conflict {
+
+constexpr const char* CACHE_FILE = "cache";
+constexpr char CACHE_MAGIC[8]    = { 'G', 'S', 'C', 'A', 'C', 'H', 'E', '\0' };
+
+bool DiskCache::open(git_repository* repo) {
+    close();
+
+    static_assert(sizeof(record_t) == 4 + (4 * sizeof(git_oid)), "records are written without padding");
+
+    m_path = std::filesystem::path(git_repository_path(repo)) / build::app_name / CACHE_FILE;
+
+    std::error_code error;
+    std::filesystem::create_directories(m_path.parent_path(), error);
+    if (error) {
+        LOG_WARN("Failed to create cache directory: {}", error.message());
+        return false;
+    }
+
+    if (git_repository_odb(&m_odb, repo) != 0) {
+        return false;
+    }
+
+    load();
+
+    // the file is created or its damaged tail is dropped
+    if ((m_rewrite || m_stale * 2 > m_records.size()) && !compact()) {
+        LOG_WARN("Failed to write cache: {}", m_path.string());
+        reset();
+        return false;
+    }
+
+    m_out.open(m_path, std::ios::binary | std::ios::app);
+    if (!m_out) {
+        LOG_WARN("Failed to open cache: {}", m_path.string());
+        reset();
+        return false;
+    }
+
+    LOG_INFO("Loaded {} cached records", m_records.size());
+    return true;
+}
+
+void DiskCache::close() {
+    if (!is_open()) {
+        return;
+    }
+
+    // the objects of the new records may exist only in memory
+    std::vector<git_oid> objects;
+    for (std::size_t i = m_stored; i < m_records.size(); ++i) {
+        const record_t& record = m_records[i];
+        const git_oid& id      = (record.kind == record_kind_t::MERGE) ? record.ids[2] : record.ids[3];
+
+        if (git_oid_is_zero(&id) == 0) {
+            objects.push_back(id);
+        }
+    }
+
+    if (!git::MemPack::get().flush(objects)) {
+        LOG_WARN("Failed to write cached objects");
+    }
+
+    m_out.close();
+
+    if ((m_rewrite || m_records.size() > MAX_RECORDS || m_stale * 2 > m_records.size()) && !compact()) {
+        LOG_WARN("Failed to compact cache: {}", m_path.string());
+    }
+
+    reset();
+}
+
+std::optional<MergeResult> DiskCache::find_merge(const MergeKey& key) {
+    std::uint32_t* position = m_merges.find(key);
+    if (position == nullptr || *position == INVALID) {
+        return std::nullopt;
+    }
+
+    const record_t& record = m_records[*position];
+    const auto status      = static_cast<ConflictStatus>(record.status);
+
+    if (status == ConflictStatus::NO_CONFLICT && !exists(record.ids[2])) {
+        *position = INVALID;
+        m_stale += 1;
+        return std::nullopt;
+    }
+
+    return MergeResult { .tree = record.ids[2], .status = status };
+}
+
+void DiskCache::insert_merge(const MergeKey& key, const MergeResult& result) {
+    if (!is_open() || (result.status != ConflictStatus::NO_CONFLICT && result.status != ConflictStatus::HAS_CONFLICT)) {
+        return;
+    }
+
+    record_t record {
+        .kind     = record_kind_t::MERGE,
+        .type     = static_cast<std::uint8_t>(key.type),
+        .status   = static_cast<std::uint8_t>(result.status),
+        .reserved = 0,
+        .ids      = { key.parent_tree, key.commit, {}, {} },
+    };
+
+    if (result.status == ConflictStatus::NO_CONFLICT) {
+        record.ids[2] = result.tree;
+    }
+
+    append(record);
+}
+
+std::optional<git_oid> DiskCache::find_resolution(const ConflictEntry& entry) {
+    std::uint32_t* position = m_resolutions.find(entry);
+    if (position == nullptr || *position == INVALID) {
+        return std::nullopt;
+    }
+
+    const git_oid& blob = m_records[*position].ids[3];
+
+    // NOTE: A zero ID means the file is deleted
+    if (git_oid_is_zero(&blob) == 0 && !exists(blob)) {
+        *position = INVALID;
+        m_stale += 1;
+        return std::nullopt;
+    }
+
+    return blob;
+}
+
+void DiskCache::insert_resolution(const ConflictEntry& entry, const git_oid& blob) {
+    if (!is_open()) {
+        return;
+    }
+
+    append(
+        record_t {
+            .kind     = record_kind_t::RESOLUTION,
+            .type     = 0,
+            .status   = 0,
+            .reserved = 0,
+            .ids      = { entry.ancestor_id, entry.their_id, entry.our_id, blob },
+        }
+    );
+}
+
+std::uint32_t* DiskCache::find_position(const record_t& record) {
+    switch (record.kind) {
+    case record_kind_t::MERGE:
+        if (record.type >= action::action_types.size()) {
+            return nullptr;
+        }
+
+        return m_merges.find(
+            MergeKey {
+                .parent_tree = record.ids[0],
+                .commit      = record.ids[1],
+                .type        = static_cast<action::ActionType>(record.type),
+            }
+        );
+
+    case record_kind_t::RESOLUTION:
+        return m_resolutions.find(
+            ConflictEntry {
+                .ancestor_id = record.ids[0],
+                .their_id    = record.ids[1],
+                .our_id      = record.ids[2],
+            }
+        );
+    }
+
+    return nullptr;
+}
+
+void DiskCache::index(std::uint32_t position) {
+    const record_t& record = m_records[position];
+
+    const auto status = static_cast<ConflictStatus>(record.status);
+
+    switch (record.kind) {
+    case record_kind_t::MERGE:
+        // NOTE: Records written by a newer version or a damaged file are skipped
+        if (record.type >= action::action_types.size()
+            || (status != ConflictStatus::NO_CONFLICT && status != ConflictStatus::HAS_CONFLICT)) {
+            m_stale += 1;
+            return;
+        }
+
+        break;
+
+    case record_kind_t::RESOLUTION:
+        break;
+
+    default:
+        m_stale += 1;
+        return;
+    }
+
+    // the previous record of the key is outdated
+    if (const std::uint32_t* previous = find_position(record); previous != nullptr && *previous != INVALID) {
+        m_stale += 1;
+    }
+
+    if (record.kind == record_kind_t::MERGE) {
+        const MergeKey key {
+            .parent_tree = record.ids[0],
+            .commit      = record.ids[1],
+            .type        = static_cast<action::ActionType>(record.type),
+        };
+
+        m_merges.insert_or_assign(key, position);
+    } else {
+        const ConflictEntry entry {
+            .ancestor_id = record.ids[0],
+            .their_id    = record.ids[1],
+            .our_id      = record.ids[2],
+        };
+
+        m_resolutions.insert_or_assign(entry, position);
+    }
+}
+
+void DiskCache::append(const record_t& record) {
+    // the same record is already stored
+    if (const std::uint32_t* position = find_position(record); position != nullptr && *position != INVALID) {
+        if (std::memcmp(&m_records[*position], &record, sizeof(record_t)) == 0) {
+            return;
+        }
+    }
+
+    // NOTE: The new records are dropped until the file is compacted
+    if (m_records.size() >= 2 * MAX_RECORDS) {
+        return;
+    }
+
+    const auto position = static_cast<std::uint32_t>(m_records.size());
+    m_records.push_back(record);
+    index(position);
+
+    if (!m_out.write(reinterpret_cast<const char*>(&record), sizeof(record_t))) {
+        m_rewrite = true;
+    }
+}
+
+bool DiskCache::exists(const git_oid& oid) { return git_odb_exists(m_odb, &oid) != 0; }
+
+void DiskCache::load() {
+    std::ifstream in(m_path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        m_rewrite = true;
+        return;
+    }
+
+    const auto size = static_cast<std::size_t>(in.tellg());
+    in.seekg(0);
+
+    header_t header;
+    if (size < sizeof(header_t) || !in.read(reinterpret_cast<char*>(&header), sizeof(header_t))
+        || std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != VERSION
+        || header.record_size != sizeof(record_t)) {
+        LOG_WARN("Discarding incompatible cache: {}", m_path.string());
+        m_rewrite = true;
+        return;
+    }
+
+    // NOTE: An interrupted write leaves a partial record at the end
+    const std::size_t count = (size - sizeof(header_t)) / sizeof(record_t);
+    if ((size - sizeof(header_t)) % sizeof(record_t) != 0) {
+        m_rewrite = true;
+    }
+
+    m_records.resize(count);
+    if (!in.read(reinterpret_cast<char*>(m_records.data()), static_cast<std::streamsize>(count * sizeof(record_t)))) {
+        m_records.clear();
+        m_rewrite = true;
+        return;
+    }
+
+    m_stored = count;
+
+    m_merges.reserve(count);
+    m_resolutions.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        index(static_cast<std::uint32_t>(i));
+    }
+}
+
+bool DiskCache::compact() {
+    // the latest records of the keys whose objects still exist
+    std::vector<record_t> kept;
+    kept.reserve(m_records.size());
+
+    for (std::size_t i = 0; i < m_records.size(); ++i) {
+        const record_t& record        = m_records[i];
+        const std::uint32_t* position = find_position(record);
+
+        if (position == nullptr || *position != i) {
+            continue;
+        }
+
+        const git_oid& id = (record.kind == record_kind_t::MERGE) ? record.ids[2] : record.ids[3];
+        if (git_oid_is_zero(&id) == 0 && !exists(id)) {
+            continue;
+        }
+
+        kept.push_back(record);
+    }
+
+    // the oldest records are dropped
+    if (kept.size() > MAX_RECORDS) {
+        kept.erase(kept.begin(), kept.end() - MAX_RECORDS);
+    }
+
+    header_t header {};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version     = VERSION;
+    header.record_size = sizeof(record_t);
+
+    // NOTE: The file is replaced at once, a failed write keeps the previous file
+    std::filesystem::path tmp_path = m_path;
+    tmp_path += ".tmp";
+
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header_t));
+        out.write(
+            reinterpret_cast<const char*>(kept.data()), static_cast<std::streamsize>(kept.size() * sizeof(record_t))
+        );
+
+        if (!out) {
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tmp_path, m_path, error);
+    if (error) {
+        std::filesystem::remove(tmp_path, error);
+        return false;
+    }
+
+    m_records = std::move(kept);
+    m_stored  = m_records.size();
+    m_stale   = 0;
+    m_rewrite = false;
+
+    m_merges.clear();
+    m_resolutions.clear();
+
+    for (std::size_t i = 0; i < m_records.size(); ++i) {
+        index(static_cast<std::uint32_t>(i));
+    }
+
+    return true;
+}
+
+void DiskCache::reset() {
+    m_out.close();
+    m_odb.destroy();
+
+    m_records.clear();
+    m_merges.clear();
+    m_resolutions.clear();
+
+    m_stored  = 0;
+    m_stale   = 0;
+    m_rewrite = false;
+}
+
+}
@@ -0,0 +1,49 @@
+#include "conflict/MergeCache.h"
+
+#include "action/Action.h"
+#include "conflict/DiskCache.h"
+
+#include <optional>
+
+#include <git2/oid.h>
+
+namespace conflict {
+
+std::optional<MergeResult>
+MergeCache::find(const git_oid& parent_tree, const git_oid& commit, action::ActionType type) {
+    const MergeKey key { parent_tree, commit, type };
+
+    auto it = m_results.find(key);
+    if (it != m_results.end()) {
+        m_hits += 1;
+        return it->second;
+    }
+
+    // results of the previous sessions
+    auto stored = DiskCache::get().find_merge(key);
+    if (!stored.has_value()) {
+        m_misses += 1;
+        return std::nullopt;
+    }
+
+    m_hits += 1;
+    m_results.emplace(key, *stored);
+    return stored;
+}
+
+void MergeCache::insert(
+    const git_oid& parent_tree, const git_oid& commit, action::ActionType type, const MergeResult& result
+) {
+    const MergeKey key { parent_tree, commit, type };
+
+    m_results.insert_or_assign(key, result);
+    DiskCache::get().insert_merge(key, result);
+}
+
+void MergeCache::clear() {
+    m_results.clear();
+    m_hits   = 0;
+    m_misses = 0;
+}
+
+}
@@ -0,0 +1,237 @@
+#include "conflict/TouchIndex.h"
+
+#include "action/Action.h"
+#include "action/ActionManager.h"
+#include "git/DiffCache.h"
+#include "git/types.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <git2/commit.h>
+#include <git2/diff.h>
+#include <git2/oid.h>
+#include <git2/tree.h>
+#include <git2/types.h>
+
+namespace conflict {
+
+bool TouchIndex::iterate(
+    action::Action& conflict_action,
+    git_repository* repo,
+    std::span<const git_oid> files,
+    const std::function<bool(std::uint32_t)>& callback
+) {
+    using action::Action;
+
+    auto& manager = action::ActionsManager::get();
+
+    git::tree_t root_tree;
+    if (git_commit_tree(&root_tree, manager.get_root_commit()) != 0) {
+        return false;
+    }
+
+    // trees of the actions before the conflicting action
+    std::vector<git_tree*> trees;
+    for (Action* act = conflict_action.get_prev(); act != nullptr; act = act->get_prev()) {
+        if (act->get_tree() == nullptr) {
+            return false;
+        }
+
+        trees.push_back(act->get_tree());
+    }
+
+    trees.push_back(root_tree.get());
+    std::reverse(trees.begin(), trees.end());
+
+    if (!update(trees, repo)) {
+        return false;
+    }
+
+    // NOTE: The conflicting action has no tree, its commit is diffed against the last tree every time
+    git::tree_t commit_tree;
+    if (git_commit_tree(&commit_tree, conflict_action.get_commit()) != 0) {
+        return false;
+    }
+
+    std::vector<change_t> changes;
+    if (!diff_trees(trees.back(), commit_tree, repo, changes)) {
+        return false;
+    }
+
+    const auto count          = static_cast<std::uint32_t>(trees.size() - 1);
+    const std::uint32_t first = manager.get_action_index(&conflict_action) - count;
+
+    std::vector<std::uint32_t> touching;
+    bool conflict_touched = false;
+
+    for (git_oid blob : files) {
+        // deleted file
+        if (git_oid_is_zero(&blob) != 0) {
+            continue;
+        }
+
+        auto change = std::find_if(changes.begin(), changes.end(), [&blob](const change_t& change) {
+            return git_oid_equal(&change.new_blob, &blob) != 0;
+        });
+
+        if (change != changes.end()) {
+            conflict_touched = true;
+            blob             = change->old_blob;
+        }
+
+        // the latest action before the limit that produced the blob
+        std::uint32_t limit = count;
+
+        while (git_oid_is_zero(&blob) == 0) {
+            const std::vector<touch_t>* touches = m_touches.find(blob);
+            if (touches == nullptr) {
+                break;
+            }
+
+            auto it = std::lower_bound(
+                touches->begin(),
+                touches->end(),
+                limit,
+                [](const touch_t& touch, std::uint32_t position) { return touch.action < position; }
+            );
+
+            if (it == touches->begin()) {
+                break;
+            }
+
+            --it;
+            touching.push_back(it->action);
+
+            blob  = it->old_blob;
+            limit = it->action;
+        }
+    }
+
+    if (conflict_touched && callback(first + count)) {
+        return true;
+    }
+
+    std::sort(touching.begin(), touching.end(), std::greater());
+    touching.erase(std::unique(touching.begin(), touching.end()), touching.end());
+
+    for (std::uint32_t position : touching) {
+        if (callback(first + position)) {
+            break;
+        }
+    }
+
+    return true;
+}
+
+void TouchIndex::clear() {
+    m_changes.clear();
+    m_trees.clear();
+    m_touches.clear();
+}
+
+bool TouchIndex::update(std::span<git_tree* const> trees, git_repository* repo) {
+    const bool unchanged = std::equal(
+        trees.begin(), trees.end(), m_trees.begin(), m_trees.end(), [](git_tree* tree, const git_oid& id) {
+            return git_oid_equal(git_tree_id(tree), &id) != 0;
+        }
+    );
+
+    if (unchanged) {
+        return true;
+    }
+
+    m_trees.clear();
+    m_touches.clear();
+
+    // only the diffs of the current trees are kept
+    changes_t next;
+    next.reserve(trees.size());
+
+    for (std::size_t i = 1; i < trees.size(); ++i) {
+        const git::DiffKey key {
+            .old_tree = *git_tree_id(trees[i - 1]),
+            .new_tree = *git_tree_id(trees[i]),
+        };
+
+        std::vector<change_t>* changes = next.find(key);
+
+        if (changes == nullptr) {
+            std::vector<change_t>* stored = m_changes.find(key);
+            std::vector<change_t> computed;
+
+            if (stored != nullptr) {
+                computed = std::move(*stored);
+            } else if (!diff_trees(trees[i - 1], trees[i], repo, computed)) {
+                m_touches.clear();
+                return false;
+            }
+
+            changes = &next.insert_or_assign(key, std::move(computed));
+        }
+
+        for (const change_t& change : *changes) {
+            m_touches[change.new_blob].push_back(
+                touch_t {
+                    .action   = static_cast<std::uint32_t>(i - 1),
+                    .old_blob = change.old_blob,
+                }
+            );
+        }
+    }
+
+    m_changes = std::move(next);
+
+    m_trees.reserve(trees.size());
+    for (git_tree* tree : trees) {
+        m_trees.push_back(*git_tree_id(tree));
+    }
+
+    return true;
+}
+
+bool TouchIndex::diff_trees(
+    git_tree* old_tree, git_tree* new_tree, git_repository* repo, std::vector<change_t>& out
+) {
+    // the same trees produce nothing
+    if (git_oid_equal(git_tree_id(old_tree), git_tree_id(new_tree)) != 0) {
+        return true;
+    }
+
+    git_diff_options diff_opts = GIT_DIFF_OPTIONS_INIT;
+
+    git_diff_find_options find_opts = GIT_DIFF_FIND_OPTIONS_INIT;
+    find_opts.flags                 = GIT_DIFF_FIND_RENAMES | GIT_DIFF_FIND_RENAMES_FROM_REWRITES;
+
+    git::diff_t diff;
+    if (git_diff_tree_to_tree(&diff, repo, old_tree, new_tree, &diff_opts) != 0
+        || git_diff_find_similar(diff, &find_opts) != 0) {
+        return false;
+    }
+
+    const std::size_t count = git_diff_num_deltas(diff);
+    for (std::size_t i = 0; i < count; ++i) {
+        const git_diff_delta* delta = git_diff_get_delta(diff, i);
+
+        // deleted files produce nothing
+        if (git_oid_is_zero(&delta->new_file.id) != 0) {
+            continue;
+        }
+
+        out.push_back(
+            change_t {
+                .old_blob = delta->old_file.id,
+                .new_blob = delta->new_file.id,
+            }
+        );
+    }
+
+    return true;
+}
+
+}
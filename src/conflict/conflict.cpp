@@ -1,17 +1,22 @@
 #include "conflict/conflict.h"
 
 #include "action/Action.h"
-#include "action/ActionManager.h"
+#include "conflict/conflict_iterator.h"
 #include "conflict/ConflictManager.h"
+#include "git/diff.h"
 #include "git/error.h"
 #include "git/types.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
-#include <functional>
+#include <optional>
 #include <span>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -25,6 +30,7 @@
 #include <git2/repository.h>
 #include <git2/status.h>
 #include <git2/strarray.h>
+#include <git2/tree.h>
 #include <git2/types.h>
 
 namespace conflict {
@@ -135,210 +141,463 @@ std::pair<ConflictStatus, git::index_t> cherrypick_check(action::Action* act, ac
     }
 }
 
-ResolutionResult add_resolved_files(
-    git::index_t& index,
+// NOTE: The paths are sorted, the views point into the diff
+static std::vector<std::string_view> changed_paths(git_diff* diff) {
+    std::vector<std::string_view> paths;
+    paths.reserve(git_diff_num_deltas(diff) * 2);
+
+    for (std::size_t i = 0; i < git_diff_num_deltas(diff); ++i) {
+        const git_diff_delta* delta = git_diff_get_delta(diff, i);
+
+        paths.emplace_back(delta->old_file.path);
+        paths.emplace_back(delta->new_file.path);
+    }
+
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+    return paths;
+}
+
+static bool overlaps(const std::vector<std::string_view>& paths, std::string_view path) {
+    // the same path or one of its parent directories
+    for (std::size_t end = path.find('/');; end = path.find('/', end + 1)) {
+        if (std::binary_search(paths.begin(), paths.end(), path.substr(0, end))) {
+            return true;
+        }
+
+        if (end == std::string_view::npos) {
+            break;
+        }
+    }
+
+    // a path inside the directory
+    std::string dir(path);
+    dir += '/';
+
+    auto it = std::lower_bound(paths.begin(), paths.end(), std::string_view(dir));
+    return it != paths.end() && it->starts_with(dir);
+}
+
+static bool is_regular_file(std::uint16_t mode) {
+    return mode == GIT_FILEMODE_BLOB || mode == GIT_FILEMODE_BLOB_EXECUTABLE;
+}
+
+static git_index_entry to_index_entry(const git_diff_file& file) {
+    git_index_entry entry {};
+    entry.id   = file.id;
+    entry.mode = file.mode;
+    entry.path = file.path;
+
+    return entry;
+}
+
+static bool is_moved(const git_diff_delta* delta) {
+    return delta->status == GIT_DELTA_RENAMED || delta->status == GIT_DELTA_COPIED;
+}
+
+// NOTE: Returns false if the changes need the full merge, the update is not set when both sides are the same
+static bool merge_entry(
     git_repository* repo,
-    std::span<const std::string> paths,
-    std::span<const ConflictEntry> entries,
-    ConflictManager& manager
+    const git_diff_delta* ours,
+    const git_diff_delta* theirs,
+    std::optional<git_tree_update>& update
 ) {
-    assert(paths.size() == entries.size());
+    // the sources of renames and copies may differ even if the results are the same
+    if (is_moved(ours) || is_moved(theirs)) {
+        return false;
+    }
 
-    ResolutionResult res;
+    // the same change on both sides
+    if (ours->status == theirs->status && ours->new_file.mode == theirs->new_file.mode
+        && git_oid_equal(&ours->new_file.id, &theirs->new_file.id) != 0) {
+        update = std::nullopt;
+        return true;
+    }
 
-    git::status_list_t list;
+    // additions, deletions and type changes are left to the full merge
+    if (ours->status != GIT_DELTA_MODIFIED || theirs->status != GIT_DELTA_MODIFIED) {
+        return false;
+    }
 
-    git_status_options opts = GIT_STATUS_OPTIONS_INIT;
-    opts.show               = GIT_STATUS_SHOW_INDEX_AND_WORKDIR;
-    opts.flags |= GIT_STATUS_OPT_INCLUDE_UNTRACKED | GIT_STATUS_OPT_RENAMES_HEAD_TO_INDEX
-        | GIT_STATUS_OPT_SORT_CASE_SENSITIVELY;
+    const std::uint16_t base_mode = ours->old_file.mode;
 
-    // shortcut
-    git_strarray& ps = opts.pathspec;
+    if (!is_regular_file(base_mode) || !is_regular_file(ours->new_file.mode)
+        || !is_regular_file(theirs->new_file.mode)) {
+        return false;
+    }
 
-    git::str_array str_storage(paths);
-    str_storage.fill(ps);
+    std::uint16_t mode = theirs->new_file.mode;
+    if (theirs->new_file.mode == base_mode) {
+        mode = ours->new_file.mode;
+    } else if (ours->new_file.mode != base_mode && ours->new_file.mode != theirs->new_file.mode) {
+        return false;
+    }
 
-    if (git_status_list_new(&list, repo, &opts) != 0) {
-        res.err = git::get_last_error();
-        return res;
+    const git_index_entry ancestor_entry = to_index_entry(ours->old_file);
+    const git_index_entry our_entry      = to_index_entry(ours->new_file);
+    const git_index_entry their_entry    = to_index_entry(theirs->new_file);
+
+    git_merge_file_result result;
+    if (git_merge_file_from_index(&result, repo, &ancestor_entry, &our_entry, &their_entry, nullptr) != 0) {
+        return false;
     }
 
-    std::size_t n = git_status_list_entrycount(list.get());
-    for (std::size_t i = 0; i < n; ++i) {
-        const git_status_entry* entry = git_status_byindex(list, i);
-        const auto status             = entry->status;
+    git_oid oid;
+    const bool merged = result.automergeable != 0
+        && git_blob_create_from_buffer(&oid, repo, result.ptr, result.len) == 0;
 
-        constexpr auto status_mask
-            = GIT_STATUS_INDEX_NEW | GIT_STATUS_INDEX_MODIFIED | GIT_STATUS_INDEX_DELETED | GIT_STATUS_INDEX_RENAMED;
+    git_merge_file_result_free(&result);
 
-        if ((status & status_mask) == 0) {
-            res.err = "Not staged changes";
-            return res;
+    if (!merged) {
+        return false;
+    }
+
+    update = git_tree_update {
+        .action   = GIT_TREE_UPDATE_UPSERT,
+        .id       = oid,
+        .filemode = static_cast<git_filemode_t>(mode),
+        .path     = theirs->new_file.path,
+    };
+
+    return true;
+}
+
+std::optional<git_oid> apply_sparse(action::Action* act, git_tree* parent_tree) {
+    git_commit* commit = act->get_commit();
+
+    // root and merge commits are always merged
+    if (git_commit_parentcount(commit) != 1) {
+        return std::nullopt;
+    }
+
+    git_repository* repo = git_commit_owner(commit);
+
+    git::commit_t base_commit;
+    git::tree_t base_tree;
+    git::tree_t act_tree;
+
+    if (git_commit_parent(&base_commit, commit, 0) != 0 || git_commit_tree(&base_tree, base_commit) != 0
+        || git_commit_tree(&act_tree, commit) != 0) {
+        return std::nullopt;
+    }
+
+    // replayed onto the original parent
+    if (git_oid_equal(git_tree_id(base_tree), git_tree_id(parent_tree)) != 0) {
+        return *git_tree_id(act_tree);
+    }
+
+    // both diffs are usually cached from the previous replay
+    auto changes  = git::prepare_diff(base_tree, act_tree, repo);
+    auto upstream = git::prepare_diff(base_tree, parent_tree, repo);
+
+    if (changes.state != git::diff_result_t::OK || upstream.state != git::diff_result_t::OK) {
+        return std::nullopt;
+    }
+
+    git_diff* changes_diff  = changes.model->diff;
+    git_diff* upstream_diff = upstream.model->diff;
+
+    const auto paths = changed_paths(changes_diff);
+
+    std::unordered_map<std::string_view, const git_diff_delta*> changed;
+    changed.reserve(git_diff_num_deltas(changes_diff));
+
+    for (std::size_t i = 0; i < git_diff_num_deltas(changes_diff); ++i) {
+        const git_diff_delta* delta = git_diff_get_delta(changes_diff, i);
+
+        // type changes are split into a deletion and an addition of the same path
+        auto [it, inserted] = changed.emplace(delta->new_file.path, delta);
+        if (!inserted) {
+            it->second = nullptr;
         }
     }
 
-    if (res.err.has_value()) {
-        return res;
+    // entries changed on both sides
+    std::unordered_map<std::string_view, std::optional<git_tree_update>> merged;
+
+    for (std::size_t i = 0; i < git_diff_num_deltas(upstream_diff); ++i) {
+        const git_diff_delta* delta = git_diff_get_delta(upstream_diff, i);
+        std::string_view path       = delta->new_file.path;
+
+        auto it = changed.find(path);
+        if (it != changed.end()) {
+            std::optional<git_tree_update> update;
+
+            if (it->second == nullptr || !merge_entry(repo, delta, it->second, update)) {
+                return std::nullopt;
+            }
+
+            merged.insert_or_assign(path, update);
+            continue;
+        }
+
+        if (overlaps(paths, delta->old_file.path) || overlaps(paths, path)) {
+            return std::nullopt;
+        }
     }
 
-    // record resolutions
-    for (std::size_t i = 0; i < entries.size(); ++i) {
-        const auto& entry = entries[i];
-        const auto& path  = paths[i];
+    std::vector<git_tree_update> updates;
+    updates.reserve(git_diff_num_deltas(changes_diff) * 2);
 
-        const git_index_entry* index_entry = git_index_get_bypath(index, path.c_str(), GIT_INDEX_STAGE_NORMAL);
-        // not found in index
-        if (index_entry == nullptr) {
-            // deleted
-            manager.add_resolution(entry, "");
+    for (std::size_t i = 0; i < git_diff_num_deltas(changes_diff); ++i) {
+        const git_diff_delta* delta = git_diff_get_delta(changes_diff, i);
+
+        auto it = merged.find(delta->new_file.path);
+        if (it != merged.end()) {
+            if (it->second.has_value()) {
+                updates.push_back(*it->second);
+            }
             continue;
         }
 
-        std::string id = git_oid_tostr_s(&index_entry->id);
-        manager.add_resolution(entry, id);
+        git_tree_update update {};
+
+        if (delta->status == GIT_DELTA_DELETED) {
+            update.action = GIT_TREE_UPDATE_REMOVE;
+            update.path   = delta->old_file.path;
+        } else {
+            // NOTE: A copy keeps its source, only a rename removes it
+            if (delta->status == GIT_DELTA_RENAMED && std::string_view(delta->old_file.path) != delta->new_file.path) {
+                git_tree_update remove {};
+                remove.action = GIT_TREE_UPDATE_REMOVE;
+                remove.path   = delta->old_file.path;
+
+                updates.push_back(remove);
+            }
+
+            update.action   = GIT_TREE_UPDATE_UPSERT;
+            update.path     = delta->new_file.path;
+            update.filemode = static_cast<git_filemode_t>(delta->new_file.mode);
+            git_oid_cpy(&update.id, &delta->new_file.id);
+        }
+
+        updates.push_back(update);
     }
 
-    if (git_index_write_tree_to(&res.id, index.get(), repo) != 0) {
-        res.err = git::get_last_error();
+    // only the trees on the changed paths are rewritten
+    git_oid oid;
+    if (git_tree_create_updated(&oid, repo, parent_tree, updates.size(), updates.data()) != 0) {
+        return std::nullopt;
     }
 
-    return res;
+    return oid;
 }
 
-struct diff_context_t {
-    void* payload;
-    std::uint32_t act_id;
-    git_oid* files;
-    std::size_t files_count;
-    std::function<bool(bool, std::uint32_t, void*)> callback;
-};
+// NOTE: Returns false if a conflict has no recorded resolution
+static bool apply_recorded(git_repository* repo, git_index* index, const resolutions_t& resolutions) {
+    std::vector<std::string> paths;
+    std::vector<ConflictEntry> entries;
 
-constexpr int REQUESTED_STOP = 250;
+    bool resolved = true;
 
-int iterate_actions_diff(const git_diff_delta* delta, float /*unused*/, void* payload) {
-    auto* ctx = static_cast<diff_context_t*>(payload);
+    bool iterator_status = iterate(index, [&](entry_data_t entry) -> bool {
+        const char* path = nullptr;
 
-    bool contains = false;
-    for (std::size_t i = 0; i < ctx->files_count; ++i) {
-        git_oid& file = ctx->files[i];
+        ConflictEntry conflict_entry;
 
-        // deleted file
-        if (git_oid_is_zero(&file) != 0) {
-            continue;
+        if (entry.our != nullptr) {
+            git_oid_cpy(&conflict_entry.our_id, &entry.our->id);
+            path = entry.our->path;
+        }
+
+        if (entry.their != nullptr) {
+            git_oid_cpy(&conflict_entry.their_id, &entry.their->id);
+
+            if (path == nullptr) {
+                path = entry.their->path;
+            }
         }
 
-        if (git_oid_equal(&delta->new_file.id, &file) != 0) {
-            // update file oid
-            git_oid_cpy(&file, &delta->old_file.id);
+        if (entry.ancestor != nullptr) {
+            git_oid_cpy(&conflict_entry.ancestor_id, &entry.ancestor->id);
 
-            contains = true;
+            if (path == nullptr) {
+                path = entry.ancestor->path;
+            }
+        }
+
+        if (!resolutions.contains(conflict_entry)) {
+            resolved = false;
+            return false;
         }
+
+        paths.emplace_back(path);
+        entries.push_back(conflict_entry);
+        return true;
+    });
+
+    if (!iterator_status || !resolved) {
+        return false;
     }
 
-    if (ctx->callback(contains, ctx->act_id, ctx->payload)) {
-        return REQUESTED_STOP;
+    // the index is changed only after the iteration
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        if (!ConflictManager::apply_resolution(resolutions, paths[i], entries[i], repo, index)) {
+            return false;
+        }
     }
 
-    return 0;
+    return true;
 }
 
-int iterate_actions_single(
-    diff_context_t& ctx,
-    git::diff_t& diff,
-    git_repository* repo,
-    git_tree* old_tree,
-    git_tree* new_tree,
-    git_diff_options* diff_opts,
-    git_diff_find_options* find_opts
+// NOTE: Same merge as cherrypick_check, the result trees are identical
+static ConflictStatus replay_step(
+    git_repository* repo, git_tree* parent_tree, ReplayStep& step, const resolutions_t& resolutions
 ) {
-    int status = git_diff_tree_to_tree(&diff, repo, old_tree, new_tree, diff_opts);
+    git::commit_t commit;
+    git::commit_t ancestor_commit;
+    git::tree_t ancestor_tree;
+    git::tree_t commit_tree;
+    git::index_t index;
+
+    if (git_commit_lookup(&commit, repo, &step.commit) != 0 || git_commit_tree(&commit_tree, commit) != 0) {
+        return ConflictStatus::ERR;
+    }
+
+    if (git_commit_parentcount(commit) == 1) {
+        if (git_commit_parent(&ancestor_commit, commit, 0) != 0
+            || git_commit_tree(&ancestor_tree, ancestor_commit) != 0) {
+            return ConflictStatus::ERR;
+        }
+    }
+
+    if (git_merge_trees(&index, repo, ancestor_tree, parent_tree, commit_tree, nullptr) != 0) {
+        return ConflictStatus::ERR;
+    }
+
+    auto status = ConflictStatus::NO_CONFLICT;
+
+    // the conflicts are resolved the same way as in the plan
+    if (git_index_has_conflicts(index) != 0) {
+        if (!apply_recorded(repo, index, resolutions)) {
+            return ConflictStatus::HAS_CONFLICT;
+        }
 
-    if (status != 0) {
-        return status;
+        status = ConflictStatus::RESOLVED_CONFLICT;
     }
 
-    git_diff_find_similar(diff, find_opts);
+    if (git_index_write_tree_to(&step.tree, index, repo) != 0) {
+        return ConflictStatus::ERR;
+    }
 
-    return git_diff_foreach(diff, iterate_actions_diff, nullptr, nullptr, nullptr, &ctx);
+    return status;
 }
 
-bool iterate_actions(
-    action::Action& conflict_action,
+bool replay_detached(
     git_repository* repo,
-    std::span<const git_oid> files,
-    std::function<bool(bool, std::uint32_t, void*)> callback,
-    void* payload
+    const git_oid& tree,
+    std::span<ReplayStep> steps,
+    const resolutions_t& resolutions,
+    const std::atomic_bool& cancel
 ) {
-    using action::Action;
+    git_oid parent_id = tree;
 
-    // prepare oids
-    std::vector<git_oid> file_ids;
-    for (auto&& file : files) {
-        file_ids.push_back(file);
-    }
+    for (auto&& step : steps) {
+        if (cancel) {
+            return false;
+        }
+
+        // dropping keeps the parent tree
+        if (step.type == action::ActionType::DROP) {
+            step.tree   = parent_id;
+            step.status = ConflictStatus::NO_CONFLICT;
+            continue;
+        }
 
-    git_diff_options diff_opts = GIT_DIFF_OPTIONS_INIT;
+        git::tree_t parent_tree;
+        if (git_tree_lookup(&parent_tree, repo, &parent_id) != 0) {
+            return false;
+        }
 
-    git_diff_find_options find_opts = GIT_DIFF_FIND_OPTIONS_INIT;
-    find_opts.flags                 = GIT_DIFF_FIND_RENAMES | GIT_DIFF_FIND_RENAMES_FROM_REWRITES;
+        step.status = replay_step(repo, parent_tree, step, resolutions);
 
-    Action* action = &conflict_action;
+        switch (step.status) {
+        case ConflictStatus::NO_CONFLICT:
+        case ConflictStatus::RESOLVED_CONFLICT:
+            parent_id = step.tree;
+            break;
 
-    git::tree_t conflict_tree;
-    git_commit* conflict_commit = action->get_commit();
+        case ConflictStatus::HAS_CONFLICT:
+            return true;
 
-    if (git_commit_tree(&conflict_tree, conflict_commit) != 0) {
-        return false;
+        case ConflictStatus::ERR:
+        case ConflictStatus::UNKNOWN:
+            return false;
+        }
     }
 
-    git_tree* new_tree = conflict_tree;
+    return true;
+}
 
-    diff_context_t ctx {
-        .payload     = payload,
-        .act_id      = action::ActionsManager::get().get_action_index(action),
-        .files       = file_ids.data(),
-        .files_count = file_ids.size(),
-        .callback    = callback,
-    };
+ResolutionResult add_resolved_files(
+    git::index_t& index,
+    git_repository* repo,
+    std::span<const std::string> paths,
+    std::span<const ConflictEntry> entries,
+    ConflictManager& manager
+) {
+    assert(paths.size() == entries.size());
 
-    do {
-        git::diff_t diff;
-        Action* prev_act = action->get_prev();
+    ResolutionResult res;
 
-        if (prev_act == nullptr) {
-            git::tree_t tree;
-            git_commit* commit = action::ActionsManager::get().get_root_commit();
+    git::status_list_t list;
 
-            if (git_commit_tree(&tree, commit) != 0) {
-                return false;
-            }
+    git_status_options opts = GIT_STATUS_OPTIONS_INIT;
+    opts.show               = GIT_STATUS_SHOW_INDEX_AND_WORKDIR;
+    opts.flags |= GIT_STATUS_OPT_INCLUDE_UNTRACKED | GIT_STATUS_OPT_RENAMES_HEAD_TO_INDEX
+        | GIT_STATUS_OPT_SORT_CASE_SENSITIVELY;
 
-            int status = iterate_actions_single(ctx, diff, repo, tree, new_tree, &diff_opts, &find_opts);
-            if (status == REQUESTED_STOP || status == 0) {
-                break;
-            } else {
-                return false;
-            }
+    // shortcut
+    git_strarray& ps = opts.pathspec;
+
+    git::str_array str_storage(paths);
+    str_storage.fill(ps);
+
+    if (git_status_list_new(&list, repo, &opts) != 0) {
+        res.err = git::get_last_error();
+        return res;
+    }
+
+    std::size_t n = git_status_list_entrycount(list.get());
+    for (std::size_t i = 0; i < n; ++i) {
+        const git_status_entry* entry = git_status_byindex(list, i);
+        const auto status             = entry->status;
+
+        constexpr auto status_mask
+            = GIT_STATUS_INDEX_NEW | GIT_STATUS_INDEX_MODIFIED | GIT_STATUS_INDEX_DELETED | GIT_STATUS_INDEX_RENAMED;
+
+        if ((status & status_mask) == 0) {
+            res.err = "Not staged changes";
+            return res;
         }
+    }
 
-        git_tree* old_tree = prev_act->get_tree();
+    if (res.err.has_value()) {
+        return res;
+    }
 
-        int status = iterate_actions_single(ctx, diff, repo, old_tree, new_tree, &diff_opts, &find_opts);
-        if (status == REQUESTED_STOP) {
-            break;
-        } else if (status != 0) {
-            return false;
+    // record resolutions
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const auto& entry = entries[i];
+        const auto& path  = paths[i];
+
+        const git_index_entry* index_entry = git_index_get_bypath(index, path.c_str(), GIT_INDEX_STAGE_NORMAL);
+        // not found in index
+        if (index_entry == nullptr) {
+            // deleted
+            manager.add_resolution(entry, git_oid {});
+            continue;
         }
 
-        // update action
-        action   = prev_act;
-        new_tree = old_tree;
-        ctx.act_id -= 1;
+        manager.add_resolution(entry, index_entry->id);
+    }
 
-    } while (true);
+    if (git_index_write_tree_to(&res.id, index.get(), repo) != 0) {
+        res.err = git::get_last_error();
+    }
 
-    return true;
+    return res;
 }
 
 }
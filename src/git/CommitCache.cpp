@@ -0,0 +1,46 @@
+#include "git/CommitCache.h"
+
+#include "git/types.h"
+
+#include <utility>
+
+#include <git2/commit.h>
+#include <git2/oid.h>
+#include <git2/types.h>
+
+namespace git {
+
+void CommitCache::attach(git_repository* repo) {
+    clear();
+    m_repo = repo;
+}
+
+git_commit* CommitCache::find(const git_oid& oid) {
+    auto it = m_index.find(oid);
+    if (it != m_index.end()) {
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return it->second->commit.get();
+    }
+
+    commit_t commit;
+    if (m_repo == nullptr || git_commit_lookup(&commit, m_repo, &oid) != 0) {
+        return nullptr;
+    }
+
+    m_entries.push_front(entry_t { .id = oid, .commit = std::move(commit) });
+    m_index.emplace(oid, m_entries.begin());
+
+    if (m_entries.size() > DEFAULT_CAPACITY) {
+        m_index.erase(m_entries.back().id);
+        m_entries.pop_back();
+    }
+
+    return m_entries.front().commit.get();
+}
+
+void CommitCache::clear() {
+    m_entries.clear();
+    m_index.clear();
+}
+
+}
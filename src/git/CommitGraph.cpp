@@ -0,0 +1,156 @@
+#include "git/CommitGraph.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <optional>
+
+#include <git2/oid.h>
+#include <git2/repository.h>
+#include <git2/types.h>
+
+namespace git {
+
+// NOTE: The format is described in Documentation/gitformat-commit-graph.txt of Git
+constexpr std::size_t HEADER_SIZE      = 8;
+constexpr std::size_t CHUNK_ENTRY_SIZE = 12;
+constexpr std::size_t FANOUT_SIZE      = 256 * 4;
+constexpr std::size_t HASH_SIZE        = 20;
+constexpr std::size_t COMMIT_DATA_SIZE = HASH_SIZE + 16;
+
+constexpr std::uint32_t CHUNK_OID_FANOUT  = 0x4f494446; // "OIDF"
+constexpr std::uint32_t CHUNK_OID_LOOKUP  = 0x4f49444c; // "OIDL"
+constexpr std::uint32_t CHUNK_COMMIT_DATA = 0x43444154; // "CDAT"
+
+constexpr std::uint32_t PARENT_NONE    = 0x70000000;
+constexpr std::uint32_t PARENT_OCTOPUS = 0x80000000;
+
+static std::uint32_t read_u32(const unsigned char* data) {
+    return (std::uint32_t(data[0]) << 24) | (std::uint32_t(data[1]) << 16) | (std::uint32_t(data[2]) << 8)
+         | std::uint32_t(data[3]);
+}
+
+static std::uint64_t read_u64(const unsigned char* data) {
+    return (std::uint64_t(read_u32(data)) << 32) | read_u32(data + 4);
+}
+
+std::optional<CommitGraph> CommitGraph::open(git_repository* repo) {
+    const auto path = std::filesystem::path(git_repository_commondir(repo)) / "objects" / "info" / "commit-graph";
+
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return std::nullopt;
+    }
+
+    CommitGraph graph;
+
+    const auto size = static_cast<std::size_t>(in.tellg());
+    in.seekg(0);
+
+    graph.m_data.resize(size);
+    if (size < HEADER_SIZE
+        || !in.read(reinterpret_cast<char*>(graph.m_data.data()), static_cast<std::streamsize>(size))) {
+        return std::nullopt;
+    }
+
+    const unsigned char* data = graph.m_data.data();
+
+    // signature, version 1, SHA-1 and no base graphs
+    if (std::memcmp(data, "CGPH", 4) != 0 || data[4] != 1 || data[5] != 1 || data[7] != 0) {
+        return std::nullopt;
+    }
+
+    const std::size_t chunks_count = data[6];
+    if (HEADER_SIZE + ((chunks_count + 1) * CHUNK_ENTRY_SIZE) > size) {
+        return std::nullopt;
+    }
+
+    std::size_t oids_size    = 0;
+    std::size_t commits_size = 0;
+
+    for (std::size_t i = 0; i < chunks_count; ++i) {
+        const unsigned char* entry = data + HEADER_SIZE + (i * CHUNK_ENTRY_SIZE);
+
+        const std::uint32_t id     = read_u32(entry);
+        const std::uint64_t offset = read_u64(entry + 4);
+        const std::uint64_t end    = read_u64(entry + 4 + CHUNK_ENTRY_SIZE);
+
+        if (offset > end || end > size) {
+            return std::nullopt;
+        }
+
+        switch (id) {
+        case CHUNK_OID_FANOUT:
+            graph.m_fanout = offset;
+            break;
+        case CHUNK_OID_LOOKUP:
+            graph.m_oids = offset;
+            oids_size    = end - offset;
+            break;
+        case CHUNK_COMMIT_DATA:
+            graph.m_commits = offset;
+            commits_size    = end - offset;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (graph.m_fanout == 0 || graph.m_oids == 0 || graph.m_commits == 0 || graph.m_fanout + FANOUT_SIZE > size) {
+        return std::nullopt;
+    }
+
+    graph.m_count = read_u32(data + graph.m_fanout + FANOUT_SIZE - 4);
+
+    if (oids_size < graph.m_count * HASH_SIZE || commits_size < graph.m_count * COMMIT_DATA_SIZE) {
+        return std::nullopt;
+    }
+
+    return graph;
+}
+
+std::optional<CommitGraphEntry> CommitGraph::find(const git_oid& oid) const {
+    const unsigned char* data = m_data.data();
+
+    // commits with the same first byte
+    const std::size_t first_byte = oid.id[0];
+
+    std::size_t low  = (first_byte == 0) ? 0 : read_u32(data + m_fanout + ((first_byte - 1) * 4));
+    std::size_t high = read_u32(data + m_fanout + (first_byte * 4));
+
+    high = std::min(high, m_count);
+
+    while (low < high) {
+        const std::size_t middle = low + ((high - low) / 2);
+        const int cmp            = std::memcmp(data + m_oids + (middle * HASH_SIZE), oid.id, HASH_SIZE);
+
+        if (cmp == 0) {
+            const unsigned char* commit = data + m_commits + (middle * COMMIT_DATA_SIZE) + HASH_SIZE;
+
+            const std::uint32_t first_parent  = read_u32(commit);
+            const std::uint32_t second_parent = read_u32(commit + 4);
+
+            std::uint32_t parent_count = 0;
+            if (first_parent != PARENT_NONE) {
+                parent_count = (second_parent == PARENT_NONE) ? 1 : 2;
+            }
+
+            return CommitGraphEntry { .parent_count = parent_count };
+        }
+
+        if (cmp < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return std::nullopt;
+}
+
+}
@@ -0,0 +1,146 @@
+#include "git/DiffCache.h"
+
+#include "git/diff.h"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include <git2/diff.h>
+#include <git2/oid.h>
+#include <git2/patch.h>
+#include <git2/tree.h>
+#include <git2/types.h>
+
+namespace git {
+
+static std::size_t estimate_memory(diff_model_t& model) {
+    std::size_t memory = sizeof(diff_model_t);
+
+    for (auto& file : model.files) {
+        memory += sizeof(diff_files_t) + file.old_file.path.size() + file.new_file.path.size();
+
+        if (file.patch != nullptr) {
+            memory += git_patch_size(file.patch, 1, 1, 1);
+        }
+
+        for (const auto& hunk : file.hunks) {
+            memory += sizeof(diff_hunk_t) + (hunk.lines.size() * sizeof(diff_line_t));
+        }
+    }
+
+    return memory;
+}
+
+std::optional<DiffKey> DiffCache::key_for(
+    git_tree* old_tree, git_tree* new_tree, const git_diff_options* opts, const git_diff_find_options* find_opts
+) {
+    DiffKey key {};
+
+    if (old_tree != nullptr) {
+        git_oid_cpy(&key.old_tree, git_tree_id(old_tree));
+    }
+
+    if (new_tree != nullptr) {
+        git_oid_cpy(&key.new_tree, git_tree_id(new_tree));
+    }
+
+    if (opts != nullptr) {
+        if (opts->pathspec.count != 0) {
+            return std::nullopt;
+        }
+
+        key.flags           = opts->flags;
+        key.context_lines   = opts->context_lines;
+        key.interhunk_lines = opts->interhunk_lines;
+    }
+
+    if (find_opts != nullptr) {
+        // NOTE: A custom similarity metric can not be compared
+        if (find_opts->metric != nullptr) {
+            return std::nullopt;
+        }
+
+        key.has_find_opts                 = true;
+        key.find_flags                    = find_opts->flags;
+        key.rename_threshold              = find_opts->rename_threshold;
+        key.rename_from_rewrite_threshold = find_opts->rename_from_rewrite_threshold;
+        key.copy_threshold                = find_opts->copy_threshold;
+        key.break_rewrite_threshold       = find_opts->break_rewrite_threshold;
+        key.rename_limit                  = find_opts->rename_limit;
+    }
+
+    return key;
+}
+
+std::shared_ptr<diff_model_t> DiffCache::find(const DiffKey& key) {
+    auto it = m_index.find(key);
+
+    if (it == m_index.end()) {
+        m_misses += 1;
+        return nullptr;
+    }
+
+    m_hits += 1;
+
+    auto entry = it->second;
+    m_entries.splice(m_entries.begin(), m_entries, entry);
+
+    // hunks could be generated since the last lookup
+    std::size_t memory = estimate_memory(*entry->model);
+    m_memory           = m_memory - entry->memory + memory;
+    entry->memory      = memory;
+
+    auto model = entry->model;
+    evict();
+
+    return model;
+}
+
+void DiffCache::insert(const DiffKey& key, std::shared_ptr<diff_model_t> model) {
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_memory -= it->second->memory;
+        m_entries.erase(it->second);
+        m_index.erase(it);
+    }
+
+    std::size_t memory = estimate_memory(*model);
+
+    m_entries.push_front(entry_t {
+        .key    = key,
+        .model  = std::move(model),
+        .memory = memory,
+    });
+    m_index.emplace(key, m_entries.begin());
+    m_memory += memory;
+
+    evict();
+}
+
+void DiffCache::set_budget(std::size_t budget) {
+    m_budget = budget;
+    evict();
+}
+
+void DiffCache::evict() {
+    // the most recently used diff is kept even if it is over the budget
+    while (m_memory > m_budget && m_entries.size() > 1) {
+        const entry_t& entry = m_entries.back();
+
+        m_memory -= entry.memory;
+        m_index.erase(entry.key);
+        m_entries.pop_back();
+    }
+}
+
+void DiffCache::clear() {
+    m_entries.clear();
+    m_index.clear();
+    m_memory = 0;
+    m_hits   = 0;
+    m_misses = 0;
+}
+
+}
@@ -0,0 +1,240 @@
+#include "git/MemPack.h"
+
+#include "git/types.h"
+#include "logging/Log.h"
+
+#include <cstddef>
+#include <format>
+#include <mutex>
+#include <span>
+#include <unordered_set>
+#include <vector>
+
+#include <git2/commit.h>
+#include <git2/odb.h>
+#include <git2/oid.h>
+#include <git2/pack.h>
+#include <git2/repository.h>
+#include <git2/sys/mempack.h>
+#include <git2/sys/odb_backend.h>
+#include <git2/tree.h>
+#include <git2/types.h>
+
+namespace git {
+
+// must be higher than the priority of the default backends, writes go to the first backend
+constexpr int MEMPACK_PRIORITY = 999;
+
+// NOTE: The mempack backend is not thread-safe, but the object database is shared with the diff workers
+struct locked_backend_t {
+    git_odb_backend parent;
+    git_odb_backend* backend;
+    std::mutex lock;
+};
+
+static locked_backend_t* to_locked(git_odb_backend* backend) { return reinterpret_cast<locked_backend_t*>(backend); }
+
+static int
+locked_read(void** data, std::size_t* size, git_object_t* type, git_odb_backend* backend, const git_oid* oid) {
+    auto* locked = to_locked(backend);
+    std::lock_guard guard(locked->lock);
+
+    return locked->backend->read(data, size, type, locked->backend, oid);
+}
+
+static int locked_read_prefix(
+    git_oid* out,
+    void** data,
+    std::size_t* size,
+    git_object_t* type,
+    git_odb_backend* backend,
+    const git_oid* prefix,
+    std::size_t len
+) {
+    auto* locked = to_locked(backend);
+    std::lock_guard guard(locked->lock);
+
+    return locked->backend->read_prefix(out, data, size, type, locked->backend, prefix, len);
+}
+
+static int locked_read_header(std::size_t* size, git_object_t* type, git_odb_backend* backend, const git_oid* oid) {
+    auto* locked = to_locked(backend);
+    std::lock_guard guard(locked->lock);
+
+    return locked->backend->read_header(size, type, locked->backend, oid);
+}
+
+static int
+locked_write(git_odb_backend* backend, const git_oid* oid, const void* data, std::size_t size, git_object_t type) {
+    auto* locked = to_locked(backend);
+    std::lock_guard guard(locked->lock);
+
+    return locked->backend->write(locked->backend, oid, data, size, type);
+}
+
+static int locked_exists(git_odb_backend* backend, const git_oid* oid) {
+    auto* locked = to_locked(backend);
+    std::lock_guard guard(locked->lock);
+
+    return locked->backend->exists(locked->backend, oid);
+}
+
+static int locked_exists_prefix(git_oid* out, git_odb_backend* backend, const git_oid* prefix, std::size_t len) {
+    auto* locked = to_locked(backend);
+    std::lock_guard guard(locked->lock);
+
+    return locked->backend->exists_prefix(out, locked->backend, prefix, len);
+}
+
+static int locked_foreach(git_odb_backend* backend, git_odb_foreach_cb cb, void* payload) {
+    auto* locked = to_locked(backend);
+    std::lock_guard guard(locked->lock);
+
+    return locked->backend->foreach (locked->backend, cb, payload);
+}
+
+static void locked_free(git_odb_backend* backend) {
+    auto* locked = to_locked(backend);
+
+    locked->backend->free(locked->backend);
+    delete locked;
+}
+
+static git_odb_backend* create_locked_backend(git_odb_backend* backend) {
+    auto* locked    = new locked_backend_t {};
+    locked->backend = backend;
+
+    git_odb_init_backend(&locked->parent, GIT_ODB_BACKEND_VERSION);
+
+    // only callbacks implemented by the backend are forwarded
+    locked->parent.read          = (backend->read != nullptr) ? locked_read : nullptr;
+    locked->parent.read_prefix   = (backend->read_prefix != nullptr) ? locked_read_prefix : nullptr;
+    locked->parent.read_header   = (backend->read_header != nullptr) ? locked_read_header : nullptr;
+    locked->parent.write         = (backend->write != nullptr) ? locked_write : nullptr;
+    locked->parent.exists        = (backend->exists != nullptr) ? locked_exists : nullptr;
+    locked->parent.exists_prefix = (backend->exists_prefix != nullptr) ? locked_exists_prefix : nullptr;
+    locked->parent.foreach       = (backend->foreach != nullptr) ? locked_foreach : nullptr;
+    locked->parent.free          = locked_free;
+
+    return &locked->parent;
+}
+
+bool MemPack::attach(git_repository* repo) {
+    m_repo    = nullptr;
+    m_backend = nullptr;
+    m_flushed.clear();
+
+    odb_t odb;
+    if (git_repository_odb(&odb, repo) != 0) {
+        return false;
+    }
+
+    git_odb_backend* mempack = nullptr;
+    if (git_mempack_new(&mempack) != 0) {
+        return false;
+    }
+
+    git_odb_backend* backend = create_locked_backend(mempack);
+
+    if (git_odb_add_backend(odb, backend, MEMPACK_PRIORITY) != 0) {
+        backend->free(backend);
+        return false;
+    }
+
+    m_repo    = repo;
+    m_backend = backend;
+
+    return true;
+}
+
+bool MemPack::in_memory(const git_oid& oid) {
+    return m_backend->exists(m_backend, &oid) != 0 && !m_flushed.contains(oid);
+}
+
+bool MemPack::flush(std::span<const git_oid> roots) {
+    if (!is_attached()) {
+        return true;
+    }
+
+    odb_t odb;
+    packbuilder_t builder;
+
+    if (git_repository_odb(&odb, m_repo) != 0 || git_packbuilder_new(&builder, m_repo) != 0) {
+        return false;
+    }
+
+    std::vector<git_oid> stack(roots.begin(), roots.end());
+    std::unordered_set<git_oid, oid_hash, oid_equal> visited;
+
+    while (!stack.empty()) {
+        git_oid oid = stack.back();
+        stack.pop_back();
+
+        // objects stored in the repository reference only objects stored in the repository
+        if (!in_memory(oid) || !visited.insert(oid).second) {
+            continue;
+        }
+
+        std::size_t size;
+        git_object_t type;
+
+        if (git_odb_read_header(&size, &type, odb, &oid) != 0) {
+            return false;
+        }
+
+        switch (type) {
+        case GIT_OBJECT_COMMIT: {
+            commit_t commit;
+            if (git_commit_lookup(&commit, m_repo, &oid) != 0) {
+                return false;
+            }
+
+            stack.push_back(*git_commit_tree_id(commit));
+
+            for (unsigned int i = 0; i < git_commit_parentcount(commit); ++i) {
+                stack.push_back(*git_commit_parent_id(commit, i));
+            }
+            break;
+        }
+
+        case GIT_OBJECT_TREE: {
+            tree_t tree;
+            if (git_tree_lookup(&tree, m_repo, &oid) != 0) {
+                return false;
+            }
+
+            for (std::size_t i = 0; i < git_tree_entrycount(tree); ++i) {
+                const git_tree_entry* entry = git_tree_entry_byindex(tree, i);
+
+                // submodules are not part of the repository
+                if (git_tree_entry_type(entry) != GIT_OBJECT_COMMIT) {
+                    stack.push_back(*git_tree_entry_id(entry));
+                }
+            }
+            break;
+        }
+
+        default:
+            break;
+        }
+
+        if (git_packbuilder_insert(builder, &oid, nullptr) != 0) {
+            return false;
+        }
+    }
+
+    if (git_packbuilder_object_count(builder) == 0) {
+        return true;
+    }
+
+    if (git_packbuilder_write(builder, nullptr, 0, nullptr, nullptr) != 0) {
+        return false;
+    }
+
+    LOG_INFO("Flushed {} objects to packfile", git_packbuilder_object_count(builder));
+
+    m_flushed.insert(visited.begin(), visited.end());
+    return true;
+}
+
+}
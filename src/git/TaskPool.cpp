@@ -0,0 +1,312 @@
+#include "git/TaskPool.h"
+
+#include "git/types.h"
+#include "logging/Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <utility>
+
+#include <git2/odb.h>
+#include <git2/repository.h>
+#include <git2/types.h>
+
+namespace git {
+
+void TaskToken::set_progress(std::uint32_t done, std::uint32_t total) {
+    m_total.store(total);
+    m_done.store(done);
+
+    if (!m_progress_cb) {
+        return;
+    }
+
+    using std::chrono::milliseconds;
+    using std::chrono::steady_clock;
+
+    const std::int64_t now = std::chrono::duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+
+    if (done != total) {
+        std::int64_t reported = m_reported.load();
+
+        // NOTE: Only one of the threads reporting at the same time calls the callback
+        if (now - reported < PROGRESS_INTERVAL_MS || !m_reported.compare_exchange_strong(reported, now)) {
+            return;
+        }
+    }
+
+    m_progress_cb(done, total);
+}
+
+TaskPool::TaskPool() {
+    const std::size_t threads_count = std::max(1U, std::thread::hardware_concurrency());
+
+    for (std::size_t i = 0; i < threads_count; ++i) {
+        m_workers.push_back(std::make_unique<worker_t>());
+    }
+
+    m_threads.reserve(threads_count);
+    for (std::size_t i = 0; i < threads_count; ++i) {
+        m_threads.emplace_back([this, i](const std::stop_token& stop) { run(i, stop); });
+    }
+}
+
+TaskPool::~TaskPool() { shutdown(); }
+
+bool TaskPool::attach(git_repository* repo) {
+    detach();
+
+    // the workers are joined
+    if (m_threads.empty()) {
+        return false;
+    }
+
+    auto source = std::make_shared<source_t>();
+    if (git_repository_odb(&source->odb, repo) != 0) {
+        return false;
+    }
+
+    m_source = std::move(source);
+    return true;
+}
+
+void TaskPool::detach() {
+    m_source = nullptr;
+
+    std::size_t removed = 0;
+
+    for (auto& worker : m_workers) {
+        std::lock_guard guard(worker->lock);
+
+        for (auto& queue : worker->queues) {
+            for (auto& job : queue) {
+                job.token->cancel();
+            }
+
+            removed += queue.size();
+            queue.clear();
+        }
+    }
+
+    std::lock_guard guard(m_lock);
+    m_queued -= removed;
+}
+
+void TaskPool::shutdown() {
+    detach();
+
+    for (auto& thread : m_threads) {
+        thread.request_stop();
+    }
+
+    for (auto& worker : m_workers) {
+        std::lock_guard guard(worker->lock);
+
+        if (worker->running != nullptr) {
+            worker->running->cancel();
+        }
+    }
+
+    m_wake.notify_all();
+
+    // NOTE: A worker releases its repository when it returns
+    for (auto& thread : m_threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    m_threads.clear();
+}
+
+std::shared_ptr<TaskToken> TaskPool::submit(TaskPriority priority, task_t task) {
+    if (m_source == nullptr) {
+        return nullptr;
+    }
+
+    auto token = std::make_shared<TaskToken>();
+
+    // NOTE: The counter is increased first, a worker may wake up before the task is queued and look again
+    {
+        std::lock_guard guard(m_lock);
+        m_queued += 1;
+    }
+
+    worker_t& worker = *m_workers[m_next_worker++ % m_workers.size()];
+
+    {
+        std::lock_guard guard(worker.lock);
+        worker.queues[static_cast<std::size_t>(priority)].push_back(job_t {
+            .task   = std::move(task),
+            .token  = token,
+            .source = m_source,
+        });
+    }
+
+    m_wake.notify_one();
+    return token;
+}
+
+bool TaskPool::take(std::size_t self, job_t& job) {
+    const std::size_t count = m_workers.size();
+
+    for (std::size_t priority = 0; priority < PRIORITY_COUNT; ++priority) {
+        for (std::size_t i = 0; i < count; ++i) {
+            worker_t& worker = *m_workers[(self + i) % count];
+
+            {
+                std::lock_guard guard(worker.lock);
+
+                auto& queue = worker.queues[priority];
+                if (queue.empty()) {
+                    continue;
+                }
+
+                // the oldest task of the own queue, the newest task of the other workers
+                if (i == 0) {
+                    job = std::move(queue.front());
+                    queue.pop_front();
+                } else {
+                    job = std::move(queue.back());
+                    queue.pop_back();
+                }
+            }
+
+            std::lock_guard guard(m_lock);
+            m_queued -= 1;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void TaskPool::run(std::size_t self, const std::stop_token& stop) {
+    std::shared_ptr<source_t> source;
+    repository_t repo;
+
+    while (!stop.stop_requested()) {
+        job_t job;
+
+        if (!take(self, job)) {
+            std::unique_lock lock(m_lock);
+            m_wake.wait(lock, stop, [this]() { return m_queued > 0; });
+            continue;
+        }
+
+        worker_t& worker = *m_workers[self];
+
+        // NOTE: The token is set first, the shutdown either cancels the task or the stop is seen below
+        {
+            std::lock_guard guard(worker.lock);
+            worker.running = job.token;
+        }
+
+        bool ready = !job.token->is_cancelled() && !stop.stop_requested();
+
+        // the repository is opened again only after another repository was attached
+        if (ready && job.source != source) {
+            repo.destroy();
+            source = nullptr;
+
+            if (git_repository_wrap_odb(&repo, job.source->odb) == 0) {
+                source = job.source;
+            } else {
+                LOG_ERROR("Failed to create worker repository");
+                job.token->cancel();
+                ready = false;
+            }
+        }
+
+        if (ready) {
+            job.task(repo, job.token);
+        }
+
+        std::lock_guard guard(worker.lock);
+        worker.running = nullptr;
+    }
+}
+
+bool TaskPool::run_batch(
+    git_repository* repo,
+    std::size_t count,
+    const std::function<bool(git_repository*, std::size_t)>& task,
+    TaskPriority priority,
+    TaskToken* token
+) {
+    struct batch_t {
+        std::atomic_size_t next     = 0;
+        std::atomic_size_t finished = 0;
+        std::atomic_bool failed     = false;
+
+        // helpers started before the caller finished, the caller waits for them
+        std::mutex lock;
+        std::condition_variable done;
+        std::size_t active = 0;
+        bool closed        = false;
+    };
+
+    auto batch = std::make_shared<batch_t>();
+
+    auto run_indices = [&task, &count, token](batch_t& state, git_repository* thread_repo) {
+        for (std::size_t i = state.next++; i < count; i = state.next++) {
+            if (token != nullptr && token->is_cancelled()) {
+                state.failed = true;
+                return;
+            }
+
+            if (!task(thread_repo, i)) {
+                state.failed = true;
+            }
+
+            if (token != nullptr) {
+                token->set_progress(
+                    static_cast<std::uint32_t>(++state.finished), static_cast<std::uint32_t>(count)
+                );
+            }
+        }
+    };
+
+    // NOTE: A helper that starts after the batch is closed returns immediately, the task, the count and the token
+    // belong to the caller
+    const std::size_t helpers = (count > 1) ? std::min(m_workers.size(), count - 1) : 0;
+
+    for (std::size_t i = 0; i < helpers; ++i) {
+        submit(priority, [batch, run_indices](git_repository* worker_repo, const auto&) {
+            {
+                std::lock_guard guard(batch->lock);
+                if (batch->closed) {
+                    return;
+                }
+
+                batch->active += 1;
+            }
+
+            run_indices(*batch, worker_repo);
+
+            std::lock_guard guard(batch->lock);
+            batch->active -= 1;
+            batch->done.notify_all();
+        });
+    }
+
+    run_indices(*batch, repo);
+
+    std::unique_lock lock(batch->lock);
+    batch->closed = true;
+    batch->done.wait(lock, [&batch]() { return batch->active == 0; });
+
+    return !batch->failed;
+}
+
+}
@@ -2,78 +2,170 @@
 
 #include "action/Action.h"
 #include "conflict/ConflictManager.h"
+#include "git/DiffCache.h"
 #include "git/types.h"
 #include "utils/unexpected.h"
 
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include <git2/buffer.h>
 #include <git2/commit.h>
 #include <git2/diff.h>
+#include <git2/errors.h>
 #include <git2/index.h>
 #include <git2/merge.h>
+#include <git2/oid.h>
 #include <git2/patch.h>
+#include <git2/repository.h>
 #include <git2/tree.h>
 #include <git2/types.h>
 
 namespace git {
 
-// NOTE: This callback is called once per file
-int diff_file_callback(const git_diff_delta* delta, float /*unused*/, void* state_raw);
+static diff_file_t create_file(const git_diff_file& file) {
+    return {
+        .path = (file.path != nullptr) ? std::string_view(file.path) : std::string_view(),
+        .id   = file.id,
+    };
+}
 
-// NOTE: This callback is called once per hunk
-int diff_hunk_callback(const git_diff_delta* delta, const git_diff_hunk* hunk, void* state_raw);
+static diff_files_t::State convert_state(git_delta_t status) {
+    switch (status) {
+    case GIT_DELTA_UNMODIFIED:
+        return diff_files_t::State::UNMODIFIED;
+    case GIT_DELTA_ADDED:
+        return diff_files_t::State::ADDED;
+    case GIT_DELTA_DELETED:
+        return diff_files_t::State::DELETED;
+    case GIT_DELTA_MODIFIED:
+        return diff_files_t::State::MODIFIED;
+    case GIT_DELTA_RENAMED:
+        return diff_files_t::State::RENAMED;
+    case GIT_DELTA_COPIED:
+        return diff_files_t::State::COPIED;
+    case GIT_DELTA_IGNORED:
+        return diff_files_t::State::IGNORED;
+    case GIT_DELTA_UNTRACKED:
+        return diff_files_t::State::UNTRACKED;
+    case GIT_DELTA_TYPECHANGE:
+        return diff_files_t::State::TYPECHANGE;
+    case GIT_DELTA_UNREADABLE:
+        return diff_files_t::State::UNREADABLE;
+    case GIT_DELTA_CONFLICTED:
+        return diff_files_t::State::CONFLICTED;
+    }
 
-// NOTE: This callback is called once per line
-int diff_line_callback(
-    const git_diff_delta* delta, const git_diff_hunk* hunk, const git_diff_line* line, void* state_raw
-);
+    UNEXPECTED("Invalid delta status");
+}
 
-class diff_state_t {
-public:
-    std::vector<diff_files_t> files;
+static std::string_view trim_newline(std::string_view str) {
+    if (str.ends_with('\r')) {
+        str = str.substr(0, str.size() - 1);
+    }
 
-    diff_files_t& add_file(const git_diff_file& old_file, const git_diff_file& new_file) {
-        return create_file(old_file, new_file);
+    if (str.ends_with('\n')) {
+        str = str.substr(0, str.size() - 1);
     }
 
-    diff_hunk_t& add_hunk() {
-        auto& file = get_file();
-        file.hunks.emplace_back();
+    return str;
+}
 
-        return file.hunks.back();
-    }
+static diff_hunk_t create_hunk(const git_diff_hunk& hunk) {
+    std::string_view str(hunk.header, hunk.header_len);
+    // "@@ ... @@ ..."
+    str = str.substr(2);
+    // " ... @@ ..."
+    str = str.substr(str.find_first_of('@'));
+    // "@@ ...
+    str = str.substr(3);
 
-    diff_files_t& get_file() { return files.back(); }
+    return {
+        .new_file = {
+            .offset = hunk.new_start,
+            .count  = hunk.new_lines,
+        },
+        .old_file = {
+            .offset = hunk.old_start,
+            .count  = hunk.old_lines,
+        },
+        .header_context = trim_newline(str),
+        .lines          = {},
+    };
+}
 
-    diff_hunk_t& get_hunk() { return get_file().hunks.back(); }
+static diff_line_t create_line(const git_diff_line& line) {
+    diff_line_t diff;
+    diff.new_lineno = line.new_lineno;
+    diff.old_lineno = line.old_lineno;
+    diff.content    = trim_newline(std::string_view(line.content, line.content_len));
 
-private:
-    static diff_file_t create_file(const git_diff_file& file) {
-        return {
-            .path = file.path,
-            .id   = file.id,
-        };
+    switch (static_cast<git_diff_line_t>(line.origin)) {
+    case GIT_DIFF_LINE_CONTEXT:
+        diff.type = diff_line_t::Type::CONTEXT;
+        break;
+    case GIT_DIFF_LINE_ADDITION:
+        diff.type = diff_line_t::Type::ADDITION;
+        break;
+    case GIT_DIFF_LINE_DELETION:
+        diff.type = diff_line_t::Type::DELETION;
+        break;
+    case GIT_DIFF_LINE_CONTEXT_EOFNL:
+        diff.type = diff_line_t::Type::CONTEXT_NO_NEWLINE;
+        break;
+    case GIT_DIFF_LINE_ADD_EOFNL:
+        diff.type = diff_line_t::Type::ADDITION_NEWLINE;
+        break;
+    case GIT_DIFF_LINE_DEL_EOFNL:
+        diff.type = diff_line_t::Type::DELETION_NEWLINE;
+        break;
+
+    case GIT_DIFF_LINE_FILE_HDR:
+    case GIT_DIFF_LINE_HUNK_HDR:
+    case GIT_DIFF_LINE_BINARY:
+        UNEXPECTED("Invalid line origin");
+        break;
     }
 
-    diff_files_t& create_file(const git_diff_file& old_file, const git_diff_file& new_file) {
-        files.push_back(
-            {
-                .new_file   = create_file(new_file),
-                .old_file   = create_file(old_file),
-                .state      = diff_files_t::State::UNMODIFIED,
-                .similarity = 0,
-                .hunks      = {},
+    return diff;
+}
+
+// NOTE: Hunks and lines point into the patch of the file
+static bool load_hunks(diff_files_t& file) {
+    const std::size_t hunks_count = git_patch_num_hunks(file.patch);
+    file.hunks.reserve(hunks_count);
+
+    for (std::size_t i = 0; i < hunks_count; ++i) {
+        const git_diff_hunk* hunk = nullptr;
+        std::size_t lines_count   = 0;
+
+        if (git_patch_get_hunk(&hunk, &lines_count, file.patch, i) != 0) {
+            return false;
+        }
+
+        diff_hunk_t& file_hunk = file.hunks.emplace_back(create_hunk(*hunk));
+        file_hunk.lines.reserve(lines_count);
+
+        for (std::size_t j = 0; j < lines_count; ++j) {
+            const git_diff_line* line = nullptr;
+
+            if (git_patch_get_line_in_hunk(&line, file.patch, i, j) != 0) {
+                return false;
             }
-        );
 
-        return files.back();
+            file_hunk.lines.push_back(create_line(*line));
+        }
     }
-};
+
+    return true;
+}
 
 diff_result_t prepare_resolution_diff(git_tree* old_tree, git_commit* new_commit, const git_diff_options* opts) {
     git_repository* repo = nullptr;
@@ -109,23 +201,111 @@ diff_result_t prepare_resolution_diff(git_tree* old_tree, git_commit* new_commit
 diff_result_t prepare_resolution_diff(
     git_tree* old_tree, action::Action* new_tree, git_repository* repo, const git_diff_options* opts
 ) {
+    return prepare_diff(old_tree, get_resolution_tree(old_tree, new_tree), repo, opts);
+}
+
+git_tree* get_resolution_tree(git_tree* old_tree, action::Action* action) {
     auto& manager             = conflict::ConflictManager::get();
-    git_tree* resolution_tree = manager.get_trees_resolution(old_tree, new_tree->get_commit());
+    git_tree* resolution_tree = manager.get_trees_resolution(old_tree, action->get_commit());
 
     if (resolution_tree == nullptr) {
-        return prepare_diff(old_tree, new_tree->get_tree(), repo, opts);
+        return action->get_tree();
     }
 
-    return prepare_diff(old_tree, resolution_tree, repo, opts);
+    return resolution_tree;
+}
+
+diff_result_t prepare_diff(
+    git_tree* old_tree,
+    git_tree* new_tree,
+    git_repository* repo,
+    const git_diff_options* opts,
+    const git_diff_find_options* find_opts
+) {
+    diff_result_t res;
+
+    auto& cache = DiffCache::get();
+    auto key    = DiffCache::key_for(old_tree, new_tree, opts, find_opts);
+
+    if (key.has_value()) {
+        res.model = cache.find(key.value());
+        if (res.model != nullptr) {
+            return res;
+        }
+    }
+
+    diff_t diff;
+    if (git_diff_tree_to_tree(&diff, repo, old_tree, new_tree, opts) != 0) {
+        res.state = diff_result_t::FAILED_TO_CREATE_DIFF;
+        return res;
+    }
+
+    auto model = create_diff(std::move(diff), find_opts);
+    if (!model.has_value()) {
+        res.state = diff_result_t::FAILED_TO_CREATE_DIFF;
+        return res;
+    }
+
+    res.model = std::make_shared<diff_model_t>(std::move(model.value()));
+
+    if (key.has_value()) {
+        cache.insert(key.value(), res.model);
+    }
+
+    return res;
+}
+
+// NOTE: Called before every file is added to the diff
+static int diff_progress(const git_diff* diff, const char* /*unused*/, const char* /*unused*/, void* payload) {
+    auto* token = static_cast<TaskToken*>(payload);
+    token->set_progress(static_cast<std::uint32_t>(git_diff_num_deltas(diff)), 0);
+
+    return token->is_cancelled() ? GIT_EUSER : 0;
 }
 
-diff_result_t prepare_diff(git_tree* old_tree, git_tree* new_tree, git_repository* repo, const git_diff_options* opts) {
+diff_result_t prepare_detached_diff(git_odb* odb, const git_oid* old_tree, const git_oid* new_tree, TaskToken& token) {
     diff_result_t res;
+    repository_t repo;
+
+    if (git_repository_wrap_odb(&repo, odb) != 0) {
+        res.state = diff_result_t::FAILED_TO_CREATE_DIFF;
+        return res;
+    }
+
+    tree_t old_obj;
+    tree_t new_obj;
+
+    if ((old_tree != nullptr && git_tree_lookup(&old_obj, repo, old_tree) != 0)
+        || (new_tree != nullptr && git_tree_lookup(&new_obj, repo, new_tree) != 0)) {
+        res.state = diff_result_t::FAILED_TO_RETRIEVE_TREE;
+        return res;
+    }
+
+    git_diff_options opts = GIT_DIFF_OPTIONS_INIT;
+    opts.progress_cb      = diff_progress;
+    opts.payload          = &token;
+
+    diff_t diff;
+    if (git_diff_tree_to_tree(&diff, repo, old_obj, new_obj, &opts) != 0) {
+        res.state = token.is_cancelled() ? diff_result_t::CANCELLED : diff_result_t::FAILED_TO_CREATE_DIFF;
+        return res;
+    }
 
-    if (git_diff_tree_to_tree(&res.diff, repo, old_tree, new_tree, opts) != 0) {
+    // NOTE: The rename detection can not be interrupted
+    if (token.is_cancelled()) {
+        res.state = diff_result_t::CANCELLED;
+        return res;
+    }
+
+    auto model = create_diff(std::move(diff));
+    if (!model.has_value()) {
         res.state = diff_result_t::FAILED_TO_CREATE_DIFF;
+        return res;
     }
 
+    res.model       = std::make_shared<diff_model_t>(std::move(model.value()));
+    res.model->repo = std::move(repo);
+
     return res;
 }
 
@@ -161,151 +341,58 @@ diff_result_t prepare_diff(git_commit* old_commit, git_commit* new_commit, const
     return prepare_diff(old_tree, new_tree, repo, opts);
 }
 
-std::vector<diff_files_t> create_diff(git_diff* diff) {
-    git_diff_find_similar(diff, nullptr);
-
-    diff_state_t state;
-
-    git_diff_foreach(diff, diff_file_callback, nullptr, diff_hunk_callback, diff_line_callback, &state);
-
-    return state.files;
-}
-
-int diff_file_callback(const git_diff_delta* delta, float /*unused*/, void* state_raw) {
-    auto* state = reinterpret_cast<diff_state_t*>(state_raw);
+std::optional<diff_model_t> create_diff(diff_t&& diff, const git_diff_find_options* find_opts) {
+    diff_model_t model;
+    model.diff = std::move(diff);
 
-    diff_files_t& file = state->add_file(delta->old_file, delta->new_file);
-    switch (delta->status) {
-    case GIT_DELTA_UNMODIFIED:
-        file.state = diff_files_t::State::UNMODIFIED;
-        break;
-    case GIT_DELTA_ADDED:
-        file.state = diff_files_t::State::ADDED;
-        break;
-    case GIT_DELTA_DELETED:
-        file.state = diff_files_t::State::DELETED;
-        break;
-    case GIT_DELTA_MODIFIED:
-        file.state = diff_files_t::State::MODIFIED;
-        break;
-    case GIT_DELTA_RENAMED:
-        file.state      = diff_files_t::State::RENAMED;
-        file.similarity = delta->similarity;
-        break;
-    case GIT_DELTA_COPIED:
-        file.state      = diff_files_t::State::COPIED;
-        file.similarity = delta->similarity;
-        break;
-    case GIT_DELTA_IGNORED:
-        file.state = diff_files_t::State::IGNORED;
-        break;
-    case GIT_DELTA_UNTRACKED:
-        file.state = diff_files_t::State::UNTRACKED;
-        break;
-    case GIT_DELTA_TYPECHANGE:
-        file.state = diff_files_t::State::TYPECHANGE;
-        break;
-    case GIT_DELTA_UNREADABLE:
-        file.state = diff_files_t::State::UNREADABLE;
-        break;
-    case GIT_DELTA_CONFLICTED:
-        file.state = diff_files_t::State::CONFLICTED;
-        break;
+    if (git_diff_find_similar(model.diff, find_opts) != 0) {
+        return std::nullopt;
     }
 
-    return 0;
-}
-
-int diff_hunk_callback(const git_diff_delta* /*unused*/, const git_diff_hunk* hunk, void* state_raw) {
-
-    auto* state            = reinterpret_cast<diff_state_t*>(state_raw);
-    diff_hunk_t& file_hunk = state->add_hunk();
+    const std::size_t deltas = git_diff_num_deltas(model.diff);
+    model.files.reserve(deltas);
 
-    std::string_view str(hunk->header, hunk->header_len);
-    // "@@ ... @@ ..."
-    str = str.substr(2);
-    // " ... @@ ..."
-    str = str.substr(str.find_first_of('@'));
-    // "@@ ...
-    str = str.substr(3);
+    for (std::size_t i = 0; i < deltas; ++i) {
+        const git_diff_delta* delta = git_diff_get_delta(model.diff, i);
 
-    if (str.ends_with('\r')) {
-        str = str.substr(0, str.size() - 1);
-    }
+        diff_files_t& file = model.files.emplace_back();
+        file.new_file      = create_file(delta->new_file);
+        file.old_file      = create_file(delta->old_file);
+        file.state         = convert_state(delta->status);
+        file.similarity    = 0;
 
-    if (str.ends_with('\n')) {
-        str = str.substr(0, str.size() - 1);
+        if (delta->status == GIT_DELTA_RENAMED || delta->status == GIT_DELTA_COPIED) {
+            file.similarity = delta->similarity;
+        }
     }
 
-    file_hunk.header_context = str;
-    file_hunk.new_file       = {
-              .offset = hunk->new_start,
-              .count  = hunk->new_lines,
-    };
-
-    file_hunk.old_file = {
-        .offset = hunk->old_start,
-        .count  = hunk->old_lines,
-    };
-
-    return 0;
+    return model;
 }
 
-int diff_line_callback(
-    const git_diff_delta* /*unused*/, const git_diff_hunk* /*unused*/, const git_diff_line* line, void* state_raw
-) {
-
-    auto* state            = reinterpret_cast<diff_state_t*>(state_raw);
-    diff_hunk_t& file_hunk = state->get_hunk();
-
-    auto origin = static_cast<git_diff_line_t>(line->origin);
-
-    diff_line_t diff;
-    diff.new_lineno = line->new_lineno;
-    diff.old_lineno = line->old_lineno;
+bool load_diff_file(diff_model_t& model, std::size_t index) {
+    diff_files_t& file = model.files[index];
+    if (file.loaded) {
+        return true;
+    }
 
-    std::string_view line_content(line->content, line->content_len);
+    // failed files are not generated again
+    file.loaded = true;
 
-    if (line_content.ends_with('\r')) {
-        line_content = line_content.substr(0, line_content.size() - 1);
+    if (git_patch_from_diff(&file.patch, model.diff, index) != 0) {
+        return false;
     }
 
-    if (line_content.ends_with('\n')) {
-        line_content = line_content.substr(0, line_content.size() - 1);
+    // NOTE: The patch is not created for binary and unmodified files
+    if (file.patch == nullptr) {
+        return true;
     }
 
-    diff.content = line_content;
-
-    switch (origin) {
-    case GIT_DIFF_LINE_CONTEXT:
-        diff.type = diff_line_t::Type::CONTEXT;
-        break;
-    case GIT_DIFF_LINE_ADDITION:
-        diff.type = diff_line_t::Type::ADDITION;
-        break;
-    case GIT_DIFF_LINE_DELETION:
-        diff.type = diff_line_t::Type::DELETION;
-        break;
-    case GIT_DIFF_LINE_CONTEXT_EOFNL:
-        diff.type = diff_line_t::Type::CONTEXT_NO_NEWLINE;
-        break;
-    case GIT_DIFF_LINE_ADD_EOFNL:
-        diff.type = diff_line_t::Type::ADDITION_NEWLINE;
-        break;
-    case GIT_DIFF_LINE_DEL_EOFNL:
-        diff.type = diff_line_t::Type::DELETION_NEWLINE;
-        break;
-
-    case GIT_DIFF_LINE_FILE_HDR:
-    case GIT_DIFF_LINE_HUNK_HDR:
-    case GIT_DIFF_LINE_BINARY:
-        UNEXPECTED("Invalid line origin");
-        break;
+    if (!load_hunks(file)) {
+        file.hunks.clear();
+        return false;
     }
 
-    file_hunk.lines.push_back(diff);
-
-    return 0;
+    return true;
 }
 
 std::optional<conflict_diff_t> create_conflict_diff(
@@ -0,0 +1,137 @@
+#include "gui/widget/ActionListModel.h"
+
+#include "action/Action.h"
+#include "action/ActionManager.h"
+#include "gui/widget/ListItem.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+#include <git2/commit.h>
+
+#include <QAbstractListModel>
+#include <QModelIndex>
+#include <QString>
+#include <QVariant>
+#include <Qt>
+
+namespace gui::widget {
+
+void ActionListModel::setActions(action::ActionsManager& manager) {
+    beginResetModel();
+
+    m_items.clear();
+    m_items.reserve(manager.size());
+
+    for (auto& action : manager) {
+        m_items.emplace_back(this, action);
+    }
+
+    endResetModel();
+}
+
+void ActionListModel::clear() {
+    beginResetModel();
+    m_items.clear();
+    endResetModel();
+}
+
+ListItem* ActionListModel::item(int row) {
+    if (row < 0 || row >= count()) {
+        return nullptr;
+    }
+
+    return &m_items[static_cast<std::size_t>(row)];
+}
+
+void ActionListModel::itemChanged(const ListItem& item) {
+    assert(!m_items.empty() && &item >= m_items.data() && &item < m_items.data() + m_items.size());
+
+    const QModelIndex changed = index(static_cast<int>(&item - m_items.data()));
+    emit dataChanged(changed, changed);
+}
+
+int ActionListModel::rowCount(const QModelIndex& parent) const {
+    // NOTE: Only the root has rows
+    if (parent.isValid()) {
+        return 0;
+    }
+
+    return count();
+}
+
+QVariant ActionListModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= count()) {
+        return {};
+    }
+
+    const ListItem& item = m_items[static_cast<std::size_t>(index.row())];
+
+    switch (role) {
+    case Qt::DisplayRole: {
+        // the summary is read from the commit when the row is painted
+        const char* summary = git_commit_summary(item.getCommitAction().get_commit());
+        return QString::fromUtf8((summary != nullptr) ? summary : "");
+    }
+
+    case Qt::ToolTipRole:
+        if (item.isPending()) {
+            return QString("Waiting for the conflict check");
+        }
+
+        if (item.hasConflictMarker()) {
+            return QString("This commit modifies conflicted file");
+        }
+
+        return {};
+
+    default:
+        return {};
+    }
+}
+
+Qt::ItemFlags ActionListModel::flags(const QModelIndex& index) const {
+    // the items are dropped between the rows
+    if (!index.isValid()) {
+        return Qt::ItemIsDropEnabled;
+    }
+
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsDragEnabled | Qt::ItemIsEditable;
+}
+
+bool ActionListModel::moveRows(
+    const QModelIndex& source_parent,
+    int source_row,
+    int count,
+    const QModelIndex& destination_parent,
+    int destination_child
+) {
+    if (source_parent.isValid() || destination_parent.isValid() || count <= 0 || source_row < 0
+        || source_row + count > this->count() || destination_child < 0 || destination_child > this->count()) {
+        return false;
+    }
+
+    // the rows are moved onto themselves
+    if (destination_child >= source_row && destination_child <= source_row + count) {
+        return false;
+    }
+
+    if (!beginMoveRows(source_parent, source_row, source_row + count - 1, destination_parent, destination_child)) {
+        return false;
+    }
+
+    auto first = m_items.begin() + source_row;
+    auto last  = first + count;
+
+    if (destination_child < source_row) {
+        std::rotate(m_items.begin() + destination_child, first, last);
+    } else {
+        std::rotate(first, last, m_items.begin() + destination_child);
+    }
+
+    endMoveRows();
+    return true;
+}
+
+}
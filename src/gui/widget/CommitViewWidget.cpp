@@ -65,6 +65,9 @@ CommitViewWidget::CommitViewWidget(DiffWidget* diff)
 
         m_diff->ensureEditorVisible(file);
     });
+
+    // NOTE: The diff is computed in the background, the list is filled once it is ready
+    connect(m_diff, &DiffWidget::diffChanged, this, &CommitViewWidget::prepareDiff);
 }
 
 void CommitViewWidget::createRows() {
@@ -154,27 +157,27 @@ void CommitViewWidget::prepareDiff() {
 
         case diff_files_t::State::ADDED:
             item_text += "New ";
-            item_text += QString::fromStdString(file_diff.new_file.path);
+            item_text += QString::fromUtf8(file_diff.new_file.path);
             break;
         case diff_files_t::State::DELETED:
             item_text += "Deleted ";
-            item_text += QString::fromStdString(file_diff.old_file.path);
+            item_text += QString::fromUtf8(file_diff.old_file.path);
             break;
         case diff_files_t::State::MODIFIED:
             item_text += "Modified ";
-            item_text += QString::fromStdString(file_diff.new_file.path);
+            item_text += QString::fromUtf8(file_diff.new_file.path);
             break;
         case diff_files_t::State::RENAMED:
             item_text += "Renamed ";
-            item_text += QString::fromStdString(file_diff.old_file.path);
+            item_text += QString::fromUtf8(file_diff.old_file.path);
             item_text += " -> ";
-            item_text += QString::fromStdString(file_diff.new_file.path);
+            item_text += QString::fromUtf8(file_diff.new_file.path);
             break;
         case diff_files_t::State::COPIED:
             item_text += "Copied ";
-            item_text += QString::fromStdString(file_diff.old_file.path);
+            item_text += QString::fromUtf8(file_diff.old_file.path);
             item_text += " -> ";
-            item_text += QString::fromStdString(file_diff.new_file.path);
+            item_text += QString::fromUtf8(file_diff.new_file.path);
             break;
         }
 
@@ -196,11 +199,18 @@ void CommitViewWidget::update(Node* node, action::Action* act) {
     m_node   = node;
     m_action = act;
 
+    m_node_commit.destroy();
+
     if (m_action == nullptr && m_node == nullptr) {
         m_commit = nullptr;
         m_diff->clear();
     } else if (m_action == nullptr) {
-        m_commit = node->getCommit();
+        git_commit* commit = node->getCommit();
+        if (commit != nullptr && git_commit_dup(&m_node_commit, commit) != 0) {
+            m_node_commit.destroy();
+        }
+
+        m_commit = m_node_commit.get();
         m_diff->update(m_commit);
     } else {
         m_commit = m_action->get_commit();
@@ -215,6 +225,8 @@ void CommitViewWidget::update(Node* node, git::diff_result_t& diff) {
     m_action = nullptr;
     m_commit = nullptr;
 
+    m_node_commit.destroy();
+
     m_diff->clear();
     m_diff->update(diff, false);
 
@@ -5,6 +5,9 @@
 #include "App.h"
 #include "conflict/conflict.h"
 #include "git/diff.h"
+#include "git/DiffCache.h"
+#include "git/error.h"
+#include "git/TaskPool.h"
 #include "git/types.h"
 #include "gui/clear_layout.h"
 #include "gui/style/DiffStyle.h"
@@ -16,31 +19,44 @@
 #include "patch/split.h"
 #include "state/CommandHistory.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <format>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include <git2/commit.h>
 #include <git2/diff.h>
 #include <git2/errors.h>
+#include <git2/oid.h>
 #include <git2/patch.h>
+#include <git2/repository.h>
+#include <git2/tree.h>
 #include <git2/types.h>
 
+#include <QCoreApplication>
 #include <QFont>
 #include <QFrame>
+#include <QLabel>
 #include <QList>
 #include <QMenu>
 #include <QMessageBox>
+#include <QMetaObject>
+#include <QPoint>
+#include <QPointer>
+#include <QRect>
 #include <QScrollArea>
 #include <QScrollBar>
 #include <QString>
 #include <QTextBlock>
 #include <QTextDocument>
 #include <QTextEdit>
+#include <QTimer>
+#include <Qt>
 #include <QVBoxLayout>
 #include <QWidget>
 
@@ -68,24 +84,155 @@ DiffWidget::DiffWidget(QWidget* parent)
 
     m_scrollarea->setWidget(m_scroll_content);
 
+    m_loading = new QLabel("Loading diff...", this);
+    m_loading->setAlignment(Qt::AlignCenter);
+    m_loading->hide();
+
     m_layout = new QVBoxLayout(this);
     m_layout->setContentsMargins(0, 0, 0, 0);
+    m_layout->addWidget(m_loading);
     m_layout->addWidget(m_scrollarea);
     setLayout(m_layout);
+
+    // NOTE: The range changes after the layout is updated, so files that became visible after loading are loaded too
+    auto* bar = m_scrollarea->verticalScrollBar();
+    connect(bar, &QScrollBar::valueChanged, this, &DiffWidget::loadVisibleFiles);
+    connect(bar, &QScrollBar::rangeChanged, this, &DiffWidget::loadVisibleFiles);
+}
+
+DiffWidget::~DiffWidget() { cancelDiff(); }
+
+DiffFile* DiffWidget::getDiffFile(std::size_t i) {
+    // the file can be requested before it was streamed
+    createFiles(i + 1);
+
+    if (i >= m_files.size()) {
+        return nullptr;
+    }
+
+    return m_files[i];
 }
 
 void DiffWidget::ensureEditorVisible(DiffFile* file) {
+    if (file == nullptr) {
+        return;
+    }
+
     auto* bar = m_scrollarea->verticalScrollBar();
     bar->setValue(file->y());
 }
 
 void DiffWidget::clear() {
+    cancelDiff();
     clear_layout(m_scroll_layout);
 
     m_files.clear();
+    m_diffs         = std::make_shared<git::diff_model_t>();
+    m_created_files = 0;
+    m_generation += 1;
     m_action = nullptr;
 }
 
+void DiffWidget::cancelDiff() {
+    if (m_task != nullptr) {
+        m_task->cancel();
+        m_task = nullptr;
+    }
+
+    m_loading->hide();
+}
+
+void DiffWidget::requestDiff(git_tree* old_tree, git_tree* new_tree, bool editable) {
+    diff_result_t res;
+
+    // NOTE: Diffs without options can always be cached
+    const git::DiffKey key = git::DiffCache::key_for(old_tree, new_tree).value();
+
+    res.model = git::DiffCache::get().find(key);
+    if (res.model != nullptr) {
+        update(res, editable);
+        return;
+    }
+
+    struct task_t {
+        git::DiffKey key;
+        bool has_old_tree;
+        bool has_new_tree;
+    };
+
+    auto task          = std::make_shared<task_t>();
+    task->key          = key;
+    task->has_old_tree = old_tree != nullptr;
+    task->has_new_tree = new_tree != nullptr;
+
+    QPointer<DiffWidget> widget = this;
+
+    m_task = git::TaskPool::get().submit(
+        git::TaskPriority::HIGH,
+        [widget, task, editable](git_repository* worker_repo, const std::shared_ptr<git::TaskToken>& token) {
+            // NOTE: The callback is owned by the token, so it keeps only a weak reference to it
+            token->on_progress([widget, weak_token = std::weak_ptr(token)](std::uint32_t done, std::uint32_t) {
+                QMetaObject::invokeMethod(
+                    QCoreApplication::instance(),
+                    [widget, weak_token, done]() {
+                        auto token = weak_token.lock();
+                        if (widget == nullptr || token == nullptr || widget->m_task != token) {
+                            return;
+                        }
+
+                        widget->m_loading->setText(QString("Loading diff... %1 files").arg(done));
+                    },
+                    Qt::QueuedConnection
+                );
+            });
+
+            diff_result_t res;
+
+            // NOTE: The diff is loaded lazily on the UI thread, so it needs its own repository
+            git::odb_t odb;
+            if (git_repository_odb(&odb, worker_repo) != 0) {
+                res.state = diff_result_t::FAILED_TO_CREATE_DIFF;
+            } else {
+                res = git::prepare_detached_diff(
+                    odb,
+                    task->has_old_tree ? &task->key.old_tree : nullptr,
+                    task->has_new_tree ? &task->key.new_tree : nullptr,
+                    *token
+                );
+            }
+
+            // NOTE: The pool outlives the widget, the result is posted to the application
+            QMetaObject::invokeMethod(
+                QCoreApplication::instance(),
+                [widget, task, token, res, editable]() mutable {
+                    if (widget == nullptr || token->is_cancelled()) {
+                        return;
+                    }
+
+                    widget->m_task = nullptr;
+                    widget->m_loading->hide();
+
+                    if (res.state == diff_result_t::OK) {
+                        git::DiffCache::get().insert(task->key, res.model);
+                    }
+
+                    widget->update(res, editable);
+                },
+                Qt::QueuedConnection
+            );
+        }
+    );
+
+    if (m_task == nullptr) {
+        res.state = diff_result_t::FAILED_TO_CREATE_DIFF;
+        update(res, editable);
+        return;
+    }
+
+    m_loading->setText("Loading diff...");
+    m_loading->show();
+}
+
 void DiffWidget::update(git_commit* commit) {
     clear();
 
@@ -95,17 +242,24 @@ void DiffWidget::update(git_commit* commit) {
 
     diff_result_t res;
     git::commit_t parent_commit;
+    git::tree_t parent_tree;
+    git::tree_t tree;
     std::uint32_t parents = git_commit_parentcount(commit);
 
-    if (parents == 0) {
-        res = git::prepare_diff(nullptr, commit);
-    } else if (parents > 1 || git_commit_parent(&parent_commit, commit, 0) != 0) {
+    if (parents > 1 || (parents == 1 && git_commit_parent(&parent_commit, commit, 0) != 0)) {
         res.state = diff_result_t::FAILED_TO_CREATE_DIFF;
-    } else {
-        res = git::prepare_diff(parent_commit, commit);
+        update(res, false);
+        return;
     }
 
-    update(res, false);
+    if ((parent_commit != nullptr && git_commit_tree(&parent_tree, parent_commit) != 0)
+        || git_commit_tree(&tree, commit) != 0) {
+        res.state = diff_result_t::FAILED_TO_RETRIEVE_TREE;
+        update(res, false);
+        return;
+    }
+
+    requestDiff(parent_tree, tree, false);
 }
 
 void DiffWidget::update(git::diff_result_t& res, bool editable) {
@@ -117,13 +271,27 @@ void DiffWidget::update(git::diff_result_t& res, bool editable) {
     case diff_result_t::FAILED_TO_CREATE_DIFF:
         QMessageBox::critical(this, "Commit diff error", "Failed to create diff");
         return;
+    case diff_result_t::CANCELLED:
+        return;
     case diff_result_t::OK:
         break;
     }
 
-    m_diffs = git::create_diff(res.diff);
-    for (std::size_t i = 0; i < m_diffs.size(); ++i) {
-        if (i != 0) {
+    m_diffs         = res.model;
+    m_editable      = editable;
+    m_created_files = 0;
+    m_generation += 1;
+
+    emit diffChanged();
+
+    streamFiles();
+}
+
+void DiffWidget::createFiles(std::size_t count) {
+    count = std::min(count, m_diffs->files.size());
+
+    for (; m_created_files < count; ++m_created_files) {
+        if (m_created_files != 0) {
             auto* line = new QFrame(this);
             line->setFrameShape(QFrame::HLine);
             line->setFrameShadow(QFrame::Sunken);
@@ -131,9 +299,25 @@ void DiffWidget::update(git::diff_result_t& res, bool editable) {
             m_scroll_layout->addWidget(line);
         }
 
-        const auto& file_diff = m_diffs[i];
-        createFileDiff(file_diff, editable);
+        createFileDiff(m_created_files, m_editable);
     }
+
+    loadVisibleFiles();
+}
+
+void DiffWidget::streamFiles() {
+    createFiles(m_created_files + FILES_PER_BATCH);
+
+    if (m_created_files == m_diffs->files.size()) {
+        return;
+    }
+
+    // the rest of the files is created after the event loop processes the pending events
+    QTimer::singleShot(0, this, [this, generation = m_generation]() {
+        if (generation == m_generation) {
+            streamFiles();
+        }
+    });
 }
 
 void DiffWidget::update(Action* action) {
@@ -147,49 +331,46 @@ void DiffWidget::update(Action* action) {
 
     Action* parent = action->get_prev();
 
-    diff_result_t res;
     if (parent == nullptr) {
         git_commit* root_commit = action::ActionsManager::get().get_root_commit();
-        git_repository* repo    = git_commit_owner(root_commit);
 
         git::tree_t root_tree;
         if (git_commit_tree(&root_tree, root_commit) != 0) {
             QMessageBox::critical(this, "Commit diff error", "Failed to retrieve tree from commit");
             return;
         }
-        res = git::prepare_diff(root_tree.get(), action->get_tree(), repo);
-
-    } else {
-        switch (parent->get_tree_status()) {
-        case ConflictStatus::UNKNOWN:
-        case ConflictStatus::ERR:
-        case ConflictStatus::HAS_CONFLICT:
-            return;
-        case ConflictStatus::NO_CONFLICT:
-        case ConflictStatus::RESOLVED_CONFLICT:
-            break;
-        }
 
-        switch (action->get_tree_status()) {
-        case ConflictStatus::UNKNOWN:
-        case ConflictStatus::ERR:
-        case ConflictStatus::HAS_CONFLICT:
-            return;
-        case ConflictStatus::NO_CONFLICT:
-        case ConflictStatus::RESOLVED_CONFLICT:
-            break;
-        }
+        requestDiff(root_tree, action->get_tree(), true);
+        return;
+    }
 
-        if (parent->get_tree() == nullptr || action->get_tree() == nullptr) {
-            return;
-        }
+    switch (parent->get_tree_status()) {
+    case ConflictStatus::UNKNOWN:
+    case ConflictStatus::ERR:
+    case ConflictStatus::HAS_CONFLICT:
+        return;
+    case ConflictStatus::NO_CONFLICT:
+    case ConflictStatus::RESOLVED_CONFLICT:
+        break;
+    }
 
-        git_repository* repo = git_commit_owner(action->get_commit());
+    switch (action->get_tree_status()) {
+    case ConflictStatus::UNKNOWN:
+    case ConflictStatus::ERR:
+    case ConflictStatus::HAS_CONFLICT:
+        return;
+    case ConflictStatus::NO_CONFLICT:
+    case ConflictStatus::RESOLVED_CONFLICT:
+        break;
+    }
 
-        res = git::prepare_resolution_diff(parent->get_tree(), action, repo);
+    if (parent->get_tree() == nullptr || action->get_tree() == nullptr) {
+        return;
     }
 
-    update(res, true);
+    git_tree* new_tree = git::get_resolution_tree(parent->get_tree(), action);
+
+    requestDiff(parent->get_tree(), new_tree, true);
 }
 
 QString create_diff_header(const diff_files_t& diff) {
@@ -197,27 +378,27 @@ QString create_diff_header(const diff_files_t& diff) {
     switch (diff.state) {
     case diff_files_t::State::ADDED:
         header += "New: ";
-        header += QString::fromStdString(diff.new_file.path);
+        header += QString::fromUtf8(diff.new_file.path);
         break;
     case diff_files_t::State::DELETED:
         header += "Deleted: ";
-        header += QString::fromStdString(diff.old_file.path);
+        header += QString::fromUtf8(diff.old_file.path);
         break;
     case diff_files_t::State::MODIFIED:
         header += "Modified: ";
-        header += QString::fromStdString(diff.new_file.path);
+        header += QString::fromUtf8(diff.new_file.path);
         break;
     case diff_files_t::State::RENAMED:
         header += "Moved: ";
-        header += QString::fromStdString(diff.old_file.path);
+        header += QString::fromUtf8(diff.old_file.path);
         header += " -> ";
-        header += QString::fromStdString(diff.new_file.path);
+        header += QString::fromUtf8(diff.new_file.path);
         break;
     case diff_files_t::State::COPIED:
         header += "Copied: ";
-        header += QString::fromStdString(diff.old_file.path);
+        header += QString::fromUtf8(diff.old_file.path);
         header += " -> ";
-        header += QString::fromStdString(diff.new_file.path);
+        header += QString::fromUtf8(diff.new_file.path);
         break;
     default:
         return "";
@@ -226,21 +407,23 @@ QString create_diff_header(const diff_files_t& diff) {
     return header;
 }
 
-void DiffWidget::createFileDiff(const diff_files_t& diff, bool editable) {
+void DiffWidget::createFileDiff(std::size_t index, bool editable) {
+    const diff_files_t& diff = m_diffs->files[index];
+
     auto* file_diff = new DiffFile(diff);
     m_curr_editor   = file_diff->getEditor();
     m_curr_editor->enableContextMenu(editable);
 
     QString header = create_diff_header(diff);
     if (header.isEmpty()) {
-        const std::string& path = (!diff.old_file.path.empty()) ? diff.old_file.path : diff.new_file.path;
+        std::string_view path = (!diff.old_file.path.empty()) ? diff.old_file.path : diff.new_file.path;
 
         LOG_ERROR("Unsupported file ({}) state: {}", path, static_cast<int>(diff.state));
         QMessageBox::critical(
             this,
             "Repository error",
             QString("Unsupported file '%1' has unsupported state: %2")
-                .arg(QString::fromStdString(path))
+                .arg(QString::fromUtf8(path))
                 .arg(QString::number(static_cast<int>(diff.state)))
         );
         return;
@@ -248,9 +431,33 @@ void DiffWidget::createFileDiff(const diff_files_t& diff, bool editable) {
 
     file_diff->setDiff(git::diff_header(diff));
     file_diff->setHeader(header);
+    file_diff->setIndex(index);
+
+    m_scroll_layout->addWidget(file_diff);
+    m_files.push_back(file_diff);
+    m_curr_editor->enableContextMenu(m_action != nullptr);
+
+    file_diff->updateEditorHeight();
+
+    connect(m_curr_editor, &DiffEditor::extendContextMenu, this, [this](QMenu* menu) {
+        menu->addSeparator();
+        auto* split_act = menu->addAction("Split commit");
+
+        connect(split_act, &QAction::triggered, this, &DiffWidget::splitCommitEvent);
+    });
+}
+
+void DiffWidget::loadFileDiff(DiffFile* file) {
+    // NOTE: The diff can be shared, so the hunks could be already generated by another view
+    if (!git::load_diff_file(*m_diffs, file->getIndex())) {
+        LOG_ERROR("Failed to load diff of the file: {}", git::get_last_error());
+    }
+
+    file->setLoaded();
+    m_curr_editor = file->getEditor();
 
     std::vector<section_t> sections;
-    for (const auto& hunk : diff.hunks) {
+    for (const auto& hunk : m_diffs->files[file->getIndex()].hunks) {
         addHunkDiff(hunk, sections);
     }
 
@@ -271,18 +478,20 @@ void DiffWidget::createFileDiff(const diff_files_t& diff, bool editable) {
     }
 
     m_curr_editor->setExtraSelections(text_sections);
-    m_scroll_layout->addWidget(file_diff);
-    m_files.push_back(file_diff);
-    m_curr_editor->enableContextMenu(m_action != nullptr);
+    file->updateEditorHeight();
+}
 
-    file_diff->updateEditorHeight();
+void DiffWidget::loadVisibleFiles() {
+    auto* bar = m_scrollarea->verticalScrollBar();
+    QRect visible(QPoint(0, bar->value()), m_scrollarea->viewport()->size());
 
-    connect(m_curr_editor, &DiffEditor::extendContextMenu, this, [this](QMenu* menu) {
-        menu->addSeparator();
-        auto* split_act = menu->addAction("Split commit");
+    for (auto* file : m_files) {
+        if (file->isLoaded() || !file->geometry().intersects(visible)) {
+            continue;
+        }
 
-        connect(split_act, &QAction::triggered, this, &DiffWidget::splitCommitEvent);
-    });
+        loadFileDiff(file);
+    }
 }
 
 void DiffWidget::addHunkDiff(const diff_hunk_t& hunk, std::vector<section_t>& sections) {
@@ -322,7 +531,7 @@ void DiffWidget::addHunkDiff(const diff_hunk_t& hunk, std::vector<section_t>& se
 void DiffWidget::addLineDiff(
     QTextCursor& cursor, const diff_hunk_t& hunk, const diff_line_t& line, std::vector<section_t>& sections
 ) {
-    QString new_content = QString::fromStdString(line.content);
+    QString new_content = QString::fromUtf8(line.content);
     new_content.prepend(' ');
 
     cursor.insertText(new_content);
@@ -1,176 +1,72 @@
 #include "gui/widget/ListItem.h"
 
 #include "action/Action.h"
+#include "action/ActionManager.h"
 #include "App.h"
-#include "gui/style/ConflictStyle.h"
-#include "gui/style/StyleManager.h"
+#include "gui/widget/ActionListModel.h"
 #include "gui/widget/RebaseViewWidget.h"
 #include "logging/Log.h"
-#include "state/CommandHistory.h"
-
-#include <QBoxLayout>
-#include <QColor>
-#include <QComboBox>
-#include <QEvent>
-#include <QLabel>
-#include <QListWidgetItem>
-#include <QObject>
-#include <QPainter>
-#include <QPalette>
-#include <QSizePolicy>
-#include <QStyledItemDelegate>
-#include <QStyleOption>
-#include <Qt>
-#include <QWidget>
 
 #include <cassert>
-#include <memory>
+
+#include <QModelIndex>
 
 namespace gui::widget {
 
-using action::Action;
 using action::ActionType;
 
-ListItem::ListItem(RebaseViewWidget* rebase, QListWidget* list, int row, Action& action)
-    : m_action(action)
-    , m_rebase(rebase)
-    , m_parent(list)
-    , m_row(row) {
-
-    m_combo = new QComboBox();
+void ListItem::changed() { m_model->itemChanged(*this); }
 
-    for (auto&& item : items) {
-        m_combo->addItem(action::type_to_str(item), static_cast<int>(item));
+void ListItem::setConflict(ConflictStatus status) {
+    if (m_conflict == status) {
+        return;
     }
 
-    m_combo->setFixedHeight(22);
-
-    m_marker = new QLabel();
-    m_marker->setFixedSize(16, 16);
-    m_marker->setToolTip("This commit modifies conflicted file");
-    m_marker->setText("●");
-    m_marker->setContentsMargins(2, 0, 0, 0);
-
-    QSizePolicy size_policy = m_marker->sizePolicy();
-    size_policy.setRetainSizeWhenHidden(true);
-    m_marker->setSizePolicy(size_policy);
-
-    hideConflictMarker();
-
-    m_text = new QLabel();
-    m_text->setMargin(0);
-    m_text->setContentsMargins(0, 0, 0, 0);
-
-    m_layout = new QHBoxLayout();
-    m_layout->setSizeConstraint(QLayout::SetMinAndMaxSize);
-    m_layout->setContentsMargins(0, 0, 0, 0);
-    m_layout->setSpacing(2);
-
-    m_layout->addWidget(m_combo);
-    m_layout->addWidget(m_marker);
-    m_layout->addWidget(m_text, 1);
-
-    setLayout(m_layout);
-    setFixedHeight(22);
-
-    m_combo->setFocusPolicy(Qt::NoFocus);
-
-    {
-        m_combo->blockSignals(true);
+    m_conflict = status;
+    changed();
+}
 
-        auto combo_index = indexOf(action.get_type());
-        m_combo->setCurrentIndex(combo_index);
-        m_combo->blockSignals(false);
+void ListItem::setDropTarget(DropTarget target) {
+    if (m_drop_target == target) {
+        return;
     }
 
-    // set default color
-    updateMarkerColor();
-
-    list->installEventFilter(this);
-
-    connect(m_combo, &QComboBox::activated, this, [this]() { this->setFocus(Qt::OtherFocusReason); });
-
-    connect(m_combo, &QComboBox::currentIndexChanged, this, [this](int index) {
-        assert(index != -1);
-
-        auto raw_type  = m_combo->itemData(index).toInt();
-        auto curr_type = static_cast<ActionType>(raw_type);
-        auto prev_type = m_action.get_type();
-
-        if (curr_type == prev_type) {
-            return;
-        }
-
-        LOG_INFO("Changing action type: from {} to {}", action::type_to_str(prev_type), action::type_to_str(curr_type));
-
-        m_action.set_type(curr_type);
-
-        state::CommandHistory::Add(std::make_unique<ListItemChangedCommand>(m_parent, m_row, prev_type, curr_type));
-
-        App::updateConflicts(m_action.get_prev());
-        App::updateGraph();
-    });
-
-    connect(&style::StyleManager::get_conflict_style(), &style::ConflictStyle::changed, this, [this]() {
-        setConflict(m_conflict);
-        updateMarkerColor();
-    });
-}
-
-void ListItem::updateMarkerColor() {
-    auto p = m_marker->palette();
-    p.setColor(QPalette::Text, style::ConflictStyle::get_color(style::ConflictStyle::CONFLICT));
-    m_marker->setPalette(p);
+    m_drop_target = target;
+    changed();
 }
 
-void ListItem::setConflict(ConflictStatus status) {
-    using ConflictColor = style::ConflictStyle::Style;
+void ListItem::setPending(bool pending) {
+    if (m_pending == pending) {
+        return;
+    }
 
-    m_conflict = status;
+    m_pending = pending;
+    changed();
+}
 
-    QColor color;
-
-    switch (status) {
-    case ConflictStatus::UNKNOWN:
-    case ConflictStatus::ERR:
-        color = style::ConflictStyle::get_color(ConflictColor::UNKNOWN);
-        break;
-    case ConflictStatus::HAS_CONFLICT:
-        color = style::ConflictStyle::get_color(ConflictColor::CONFLICT);
-        break;
-    case ConflictStatus::NO_CONFLICT:
-        color = style::ConflictStyle::get_color(ConflictColor::NORMAL);
-        break;
-    case ConflictStatus::RESOLVED_CONFLICT:
-        color = style::ConflictStyle::get_color(ConflictColor::RESOLVED_CONFLICT);
-        break;
+void ListItem::setConflictMarker(bool visible) {
+    if (m_marker == visible) {
+        return;
     }
 
-    auto p = m_text->palette();
-    p.setColor(QPalette::Text, color);
-    m_text->setPalette(p);
+    m_marker = visible;
+    changed();
 }
 
-bool ListItem::eventFilter(QObject* obj, QEvent* event) {
-    if (event->type() == QEvent::KeyPress) {
-        auto* key_event = static_cast<QKeyEvent*>(event);
-
-        if (m_parent->itemWidget(m_parent->currentItem()) == this) {
-            auto key = key_event->key();
+void ListItem::setActionType(ActionType type) {
+    LOG_INFO(
+        "Changing action type: from {} to {}", action::type_to_str(m_action->get_type()), action::type_to_str(type)
+    );
 
-            if (key == Qt::Key_Enter || key == Qt::Key_Return) {
-                m_combo->showPopup();
-                return true;
-            }
-        }
-    }
+    assert(indexOf(type) != -1);
 
-    return QWidget::eventFilter(obj, event);
+    action::ActionsManager::get().set_type(m_action, type);
+    changed();
 }
 
-ListItemMoveCommand::ListItemMoveCommand(RebaseViewWidget* rebase, QListWidget* parent, int prev_row, int curr_row)
+ListItemMoveCommand::ListItemMoveCommand(RebaseViewWidget* rebase, ActionListModel* model, int prev_row, int curr_row)
     : m_rebase(rebase)
-    , m_parent(parent)
+    , m_model(model)
     , m_prev(prev_row)
     , m_curr(curr_row) { }
 
@@ -180,8 +76,6 @@ void ListItemMoveCommand::undo() { move(m_curr, m_prev); }
 
 void ListItemMoveCommand::move(int from, int to) {
 
-    auto* model = m_parent->model();
-
     int new_row = to;
     if (from <= to) {
         new_row += 1;
@@ -189,15 +83,15 @@ void ListItemMoveCommand::move(int from, int to) {
 
     m_rebase->ignoreMoveSignal(true);
 
-    model->moveRow(QModelIndex(), from, QModelIndex(), new_row);
+    m_model->moveRow(QModelIndex(), from, QModelIndex(), new_row);
 
     m_rebase->ignoreMoveSignal(false);
 
     m_rebase->moveAction(from, to);
 }
 
-ListItemChangedCommand::ListItemChangedCommand(QListWidget* parent, int row, ActionType prev, ActionType curr)
-    : m_parent(parent)
+ListItemChangedCommand::ListItemChangedCommand(ActionListModel* model, int row, ActionType prev, ActionType curr)
+    : m_model(model)
     , m_row(row)
     , m_prev(prev)
     , m_curr(curr) { }
@@ -207,13 +101,13 @@ void ListItemChangedCommand::execute() { set_type(m_curr); }
 void ListItemChangedCommand::undo() { set_type(m_prev); }
 
 void ListItemChangedCommand::set_type(ActionType type) {
-    auto* item      = m_parent->item(m_row);
-    auto* list_item = dynamic_cast<ListItem*>(m_parent->itemWidget(item));
+    ListItem* list_item = m_model->item(m_row);
+    assert(list_item != nullptr);
 
-    list_item->setActionTypeNoSignal(type);
+    list_item->setActionType(type);
 
-    App::updateConflicts(list_item->getCommitAction().get_prev());
-    App::updateGraph();
+    auto& act = list_item->getCommitAction();
+    App::updateConflicts(act.get_prev(), act.get_next());
 }
 
 }
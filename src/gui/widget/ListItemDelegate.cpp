@@ -0,0 +1,268 @@
+#include "gui/widget/ListItemDelegate.h"
+
+#include "action/Action.h"
+#include "gui/style/ConflictStyle.h"
+#include "gui/widget/ActionListModel.h"
+#include "gui/widget/ListItem.h"
+#include "state/CommandHistory.h"
+
+#include <algorithm>
+#include <memory>
+
+#include <QAbstractItemModel>
+#include <QAbstractItemView>
+#include <QApplication>
+#include <QColor>
+#include <QComboBox>
+#include <QEvent>
+#include <QFont>
+#include <QFontMetrics>
+#include <QMetaObject>
+#include <QModelIndex>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPalette>
+#include <QPersistentModelIndex>
+#include <QRect>
+#include <QSize>
+#include <QString>
+#include <QStyle>
+#include <QStyledItemDelegate>
+#include <QStyleOptionComboBox>
+#include <QStyleOptionViewItem>
+#include <Qt>
+#include <QWidget>
+
+namespace gui::widget {
+
+using action::ActionType;
+
+static QColor conflict_color(ListItem::ConflictStatus status) {
+    using ConflictColor  = style::ConflictStyle::Style;
+    using ConflictStatus = ListItem::ConflictStatus;
+
+    switch (status) {
+    case ConflictStatus::UNKNOWN:
+    case ConflictStatus::ERR:
+        return style::ConflictStyle::get_color(ConflictColor::UNKNOWN);
+    case ConflictStatus::HAS_CONFLICT:
+        return style::ConflictStyle::get_color(ConflictColor::CONFLICT);
+    case ConflictStatus::NO_CONFLICT:
+        return style::ConflictStyle::get_color(ConflictColor::NORMAL);
+    case ConflictStatus::RESOLVED_CONFLICT:
+        return style::ConflictStyle::get_color(ConflictColor::RESOLVED_CONFLICT);
+    }
+
+    return {};
+}
+
+static QStyle* widget_style(const QStyleOptionViewItem& option) {
+    return (option.widget != nullptr) ? option.widget->style() : QApplication::style();
+}
+
+ListItemDelegate::ListItemDelegate(QAbstractItemView* view)
+    : QStyledItemDelegate(view)
+    , m_view(view) { }
+
+QRect ListItemDelegate::typeRect(const QStyleOptionViewItem& option) const {
+    if (m_type_width < 0) {
+        int text_width = 0;
+        for (ActionType type : ListItem::items) {
+            text_width = std::max(text_width, option.fontMetrics.horizontalAdvance(action::type_to_str(type)));
+        }
+
+        QStyleOptionComboBox combo;
+        combo.initFrom(m_view);
+
+        const QSize size = widget_style(option)->sizeFromContents(
+            QStyle::CT_ComboBox, &combo, QSize(text_width, option.fontMetrics.height()), option.widget
+        );
+
+        m_type_width = size.width();
+    }
+
+    return { option.rect.left(), option.rect.top(), m_type_width, HEIGHT };
+}
+
+void ListItemDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const {
+    using ConflictColor = style::ConflictStyle::Style;
+    using DropTarget    = ListItem::DropTarget;
+
+    const auto* model    = static_cast<const ActionListModel*>(index.model());
+    const ListItem* item = model->item(index);
+    if (item == nullptr) {
+        return;
+    }
+
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+
+    QStyle* view_style = widget_style(opt);
+
+    // selection and hover
+    opt.text.clear();
+    view_style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, opt.widget);
+
+    switch (item->getDropTarget()) {
+    case DropTarget::NONE:
+        break;
+
+    case DropTarget::COMMUTES:
+    case DropTarget::CONFLICTS: {
+        QColor color = style::ConflictStyle::get_color(
+            (item->getDropTarget() == DropTarget::COMMUTES) ? ConflictColor::COMMUTES : ConflictColor::CONFLICT
+        );
+        color.setAlpha(DROP_TARGET_ALPHA);
+        painter->fillRect(opt.rect, color);
+        break;
+    }
+    }
+
+    painter->save();
+
+    // the type selector looks like the combo box created by the editor
+    const ActionType type = item->getCommitAction().get_type();
+
+    QStyleOptionComboBox combo;
+    combo.initFrom(m_view);
+    combo.rect        = typeRect(opt);
+    combo.currentText = action::type_to_str(type);
+    combo.state       = opt.state & QStyle::State_Enabled;
+
+    view_style->drawComplexControl(QStyle::CC_ComboBox, &combo, painter, opt.widget);
+    view_style->drawControl(QStyle::CE_ComboBoxLabel, &combo, painter, opt.widget);
+
+    const QRect marker_rect {
+        combo.rect.right() + 1 + SPACING,
+        opt.rect.top() + ((opt.rect.height() - MARKER_SIZE) / 2),
+        MARKER_SIZE,
+        MARKER_SIZE,
+    };
+
+    if (item->hasConflictMarker()) {
+        painter->setPen(style::ConflictStyle::get_color(ConflictColor::CONFLICT));
+        painter->drawText(marker_rect, Qt::AlignCenter, "●");
+    }
+
+    QRect text_rect = opt.rect;
+    text_rect.setLeft(marker_rect.right() + 1 + SPACING);
+
+    QFont font = opt.font;
+    font.setItalic(item->isPending());
+    painter->setFont(font);
+
+    QColor color = conflict_color(item->getConflict());
+    if (!color.isValid()) {
+        color = opt.palette.color(QPalette::Text);
+    }
+
+    const QString text = QFontMetrics(font).elidedText(
+        index.data(Qt::DisplayRole).toString(), Qt::ElideRight, text_rect.width()
+    );
+
+    painter->setPen(color);
+    painter->drawText(text_rect, Qt::AlignLeft | Qt::AlignVCenter, text);
+
+    painter->restore();
+}
+
+QSize ListItemDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const {
+    const int text_width = option.fontMetrics.horizontalAdvance(index.data(Qt::DisplayRole).toString());
+
+    return { typeRect(option).width() + SPACING + MARKER_SIZE + SPACING + text_width, HEIGHT };
+}
+
+QWidget* ListItemDelegate::createEditor(
+    QWidget* parent, const QStyleOptionViewItem& /*option*/, const QModelIndex& /*index*/
+) const {
+    auto* combo = new QComboBox(parent);
+
+    for (ActionType type : ListItem::items) {
+        combo->addItem(action::type_to_str(type), static_cast<int>(type));
+    }
+
+    connect(combo, &QComboBox::activated, this, &ListItemDelegate::commitAndCloseEditor);
+
+    // NOTE: The editor is shown once it has its geometry
+    QMetaObject::invokeMethod(combo, &QComboBox::showPopup, Qt::QueuedConnection);
+
+    return combo;
+}
+
+void ListItemDelegate::setEditorData(QWidget* editor, const QModelIndex& index) const {
+    auto* combo          = static_cast<QComboBox*>(editor);
+    const auto* model    = static_cast<const ActionListModel*>(index.model());
+    const ListItem* item = model->item(index);
+
+    if (item != nullptr) {
+        combo->setCurrentIndex(ListItem::indexOf(item->getCommitAction().get_type()));
+    }
+}
+
+void ListItemDelegate::setModelData(QWidget* editor, QAbstractItemModel* model, const QModelIndex& index) const {
+    using state::CommandHistory;
+
+    auto* combo      = static_cast<QComboBox*>(editor);
+    auto* list_model = static_cast<ActionListModel*>(model);
+    ListItem* item   = list_model->item(index);
+
+    if (item == nullptr || combo->currentIndex() < 0) {
+        return;
+    }
+
+    const auto curr_type = static_cast<ActionType>(combo->currentData().toInt());
+    const auto prev_type = item->getCommitAction().get_type();
+
+    if (curr_type == prev_type) {
+        return;
+    }
+
+    auto* cmd = new ListItemChangedCommand(list_model, index.row(), prev_type, curr_type);
+
+    CommandHistory::Add(std::unique_ptr<ListItemChangedCommand>(cmd));
+
+    cmd->execute();
+}
+
+void ListItemDelegate::updateEditorGeometry(
+    QWidget* editor, const QStyleOptionViewItem& option, const QModelIndex& /*index*/
+) const {
+    editor->setGeometry(typeRect(option));
+}
+
+bool ListItemDelegate::editorEvent(
+    QEvent* event, QAbstractItemModel* model, const QStyleOptionViewItem& option, const QModelIndex& index
+) {
+    // the row is selected by the press, the release on the selector opens the editor
+    if (event->type() == QEvent::MouseButtonRelease) {
+        auto* mouse_event = static_cast<QMouseEvent*>(event);
+
+        if (mouse_event->button() == Qt::LeftButton && typeRect(option).contains(mouse_event->position().toPoint())) {
+            QMetaObject::invokeMethod(
+                m_view,
+                [view = m_view, editing = QPersistentModelIndex(index)]() {
+                    if (editing.isValid()) {
+                        view->edit(editing);
+                    }
+                },
+                Qt::QueuedConnection
+            );
+
+            return true;
+        }
+    }
+
+    return QStyledItemDelegate::editorEvent(event, model, option, index);
+}
+
+void ListItemDelegate::commitAndCloseEditor() {
+    auto* editor = qobject_cast<QComboBox*>(sender());
+    if (editor == nullptr) {
+        return;
+    }
+
+    emit commitData(editor);
+    emit closeEditor(editor);
+}
+
+}
@@ -2,17 +2,27 @@
 
 #include "action/Action.h"
 #include "action/ActionManager.h"
+#include "action/PlanSnapshot.h"
 #include "conflict/conflict.h"
 #include "conflict/conflict_iterator.h"
+#include "conflict/CommuteMatrix.h"
 #include "conflict/ConflictManager.h"
+#include "conflict/MergeCache.h"
+#include "conflict/TouchIndex.h"
+#include "git/CommitCache.h"
 #include "git/diff.h"
+#include "git/DiffCache.h"
 #include "git/error.h"
 #include "git/GitGraph.h"
 #include "git/head.h"
+#include "git/MemPack.h"
 #include "git/parser.h"
+#include "git/TaskPool.h"
 #include "git/types.h"
+#include "gui/style/ConflictStyle.h"
 #include "gui/style/GlobalStyle.h"
 #include "gui/style/StyleManager.h"
+#include "gui/widget/ActionListModel.h"
 #include "gui/widget/CommitViewWidget.h"
 #include "gui/widget/ConflictDialog.h"
 #include "gui/widget/ConflictWidget.h"
@@ -21,6 +31,7 @@
 #include "gui/widget/graph/Node.h"
 #include "gui/widget/LineSplitter.h"
 #include "gui/widget/ListItem.h"
+#include "gui/widget/ListItemDelegate.h"
 #include "gui/widget/ScrollListWidget.h"
 #include "logging/Log.h"
 #include "state/CommandHistory.h"
@@ -28,7 +39,9 @@
 #include "utils/todo.h"
 #include "utils/unexpected.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <format>
 #include <memory>
@@ -54,19 +67,24 @@
 #include <git2/types.h>
 
 #include <QAbstractItemModel>
+#include <QAbstractItemView>
 #include <QBoxLayout>
 #include <QColor>
-#include <QComboBox>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QItemSelectionModel>
 #include <QLabel>
 #include <QList>
-#include <QListWidgetItem>
 #include <QMessageBox>
+#include <QMetaObject>
 #include <QObject>
 #include <QPalette>
+#include <QPointer>
 #include <QPushButton>
 #include <QSplitter>
 #include <QString>
 #include <Qt>
+#include <QTimer>
 #include <QWidget>
 
 namespace gui::widget {
@@ -105,6 +123,12 @@ RebaseViewWidget::RebaseViewWidget(QWidget* parent)
 
     //-- LEFT LAYOUT --------------------------------------------------------//
     m_list_actions = new ScrollListWidget();
+    m_list_model   = new ActionListModel(this);
+
+    m_list_actions->setModel(m_list_model);
+    m_list_actions->setItemDelegate(new ListItemDelegate(m_list_actions));
+    m_list_actions->setUniformItemSizes(true);
+    m_list_actions->setEditTriggers(QAbstractItemView::EditTrigger::EditKeyPressed);
     m_list_actions->setSelectionMode(QAbstractItemView::SelectionMode::SingleSelection);
     m_list_actions->setDragDropMode(QAbstractItemView::DragDropMode::InternalMove);
     m_list_actions->setDragEnabled(true);
@@ -157,7 +181,36 @@ RebaseViewWidget::RebaseViewWidget(QWidget* parent)
         m_list_actions->setPalette(p);
     });
 
-    connect(m_list_actions, &QListWidget::itemSelectionChanged, this, [this]() { changeItemSelection(); });
+    // the rows are painted with the current colors
+    connect(&style::StyleManager::get_conflict_style(), &style::ConflictStyle::changed, this, [this]() {
+        m_list_actions->viewport()->update();
+    });
+
+    connect(m_list_actions->selectionModel(), &QItemSelectionModel::selectionChanged, this, [this]() {
+        changeItemSelection();
+    });
+
+    m_recompute_timer = new QTimer(this);
+    m_recompute_timer->setSingleShot(true);
+    m_recompute_timer->setInterval(RECOMPUTE_DELAY_MS);
+
+    connect(m_recompute_timer, &QTimer::timeout, this, [this]() { flushConflicts(); });
+
+    connect(m_list_actions, &ScrollListWidget::dragStarted, this, [this](int row) {
+        // the drop targets and the preview need the current trees
+        flushConflicts();
+
+        m_drag_row = row;
+        markDropTargets(row);
+    });
+
+    connect(m_list_actions, &ScrollListWidget::dragTargetChanged, this, [this](int row) { previewDrop(row); });
+
+    connect(m_list_actions, &ScrollListWidget::dragFinished, this, [this]() {
+        cancelPreview();
+        m_drag_row = -1;
+        clearDropTargets();
+    });
 
     auto handle_old = [&](Node* prev, Node* next) { this->showCommit(prev, next, false); };
     auto handle_new = [&](Node* prev, Node* next) { this->showCommit(prev, next, true); };
@@ -166,7 +219,7 @@ RebaseViewWidget::RebaseViewWidget(QWidget* parent)
     m_new_commits_graph->setHandle(handle_new);
 
     connect(
-        m_list_actions->model(),
+        m_list_model,
         &QAbstractItemModel::rowsMoved,
         this,
         [this](
@@ -184,7 +237,7 @@ RebaseViewWidget::RebaseViewWidget(QWidget* parent)
             }
 
             state::CommandHistory::Add(
-                std::make_unique<ListItemMoveCommand>(this, m_list_actions, source_row, destination_row)
+                std::make_unique<ListItemMoveCommand>(this, m_list_model, source_row, destination_row)
             );
 
             this->moveAction(source_row, destination_row);
@@ -193,16 +246,14 @@ RebaseViewWidget::RebaseViewWidget(QWidget* parent)
 }
 
 void RebaseViewWidget::changeItemSelection() {
-    QListWidget* list = m_list_actions;
-    auto selected     = list->selectedItems();
+    auto selected = m_list_actions->selectionModel()->selectedRows();
     if (selected.size() != 1) {
         m_commit_view->update(nullptr);
         showConflict(nullptr);
         return;
     }
 
-    QListWidgetItem* item = selected.first();
-    auto* list_item       = dynamic_cast<ListItem*>(list->itemWidget(item));
+    ListItem* list_item = getListItem(selected.first().row());
     if (list_item == nullptr) {
         return;
     }
@@ -253,26 +304,171 @@ void RebaseViewWidget::updateConflictMarkers() {
         return;
     }
 
-    conflict::iterate_actions(
-        *m_cherrypick,
-        m_repo,
-        m_conflict_files,
-        [this](bool conflict, std::uint32_t action_id, void*) -> bool {
-            if (conflict) {
-                auto* item = getListItem(static_cast<int>(action_id));
-                if (item != nullptr) {
-                    item->showConflictMarker();
-                }
+    // NOTE: If all commits are known, the markers are predicted from the lines changed in the conflicting files and
+    // nothing is diffed
+    auto& matrix        = conflict::CommuteMatrix::get();
+    auto conflict_index = matrix.index_of(m_cherrypick->get_oid());
+    bool predicted      = conflict_index.has_value();
+
+    for (Action* act = m_cherrypick->get_prev(); predicted && act != nullptr; act = act->get_prev()) {
+        predicted = act->get_type() == ActionType::DROP || matrix.index_of(act->get_oid()).has_value();
+    }
+
+    if (predicted) {
+        auto* conflict_item = getListItem(static_cast<int>(m_actions.get_action_index(m_cherrypick)));
+        if (conflict_item != nullptr) {
+            conflict_item->showConflictMarker();
+        }
+
+        for (Action* act = m_cherrypick->get_prev(); act != nullptr; act = act->get_prev()) {
+            // dropped actions change nothing
+            if (act->get_type() == ActionType::DROP) {
+                continue;
+            }
+
+            const std::size_t index = *matrix.index_of(act->get_oid());
+
+            const bool conflicts = std::ranges::any_of(m_conflict_paths, [&](const std::string& path) {
+                return matrix.may_conflict(*conflict_index, index, path);
+            });
+
+            if (!conflicts) {
+                continue;
+            }
+
+            auto* item = getListItem(static_cast<int>(m_actions.get_action_index(act)));
+            if (item != nullptr) {
+                item->showConflictMarker();
+            }
+        }
+
+        return;
+    }
+
+    bool status = conflict::TouchIndex::get().iterate(
+        *m_cherrypick, m_repo, m_conflict_files, [this](std::uint32_t action_id) -> bool {
+            auto* item = getListItem(static_cast<int>(action_id));
+            if (item != nullptr) {
+                item->showConflictMarker();
             }
+
             return false;
-        },
-        nullptr
+        }
     );
+
+    if (!status) {
+        utils::log_libgit_error();
+    }
 }
 
-void RebaseViewWidget::updateConflictList(Action* start) {
-    using conflict::ConflictStatus;
+// checks whether the replayed action produced the same result as before
+static bool has_same_result(const Action* act, Action::ConflictStatus old_status, const git_oid& old_tree) {
+    using ConflictStatus = Action::ConflictStatus;
+
+    switch (act->get_tree_status()) {
+    case ConflictStatus::UNKNOWN:
+    case ConflictStatus::ERR:
+        return false;
+
+    // every following action is unknown
+    case ConflictStatus::HAS_CONFLICT:
+        return old_status == ConflictStatus::HAS_CONFLICT;
+
+    case ConflictStatus::NO_CONFLICT:
+    case ConflictStatus::RESOLVED_CONFLICT:
+        break;
+    }
+
+    if (old_status != ConflictStatus::NO_CONFLICT && old_status != ConflictStatus::RESOLVED_CONFLICT) {
+        return false;
+    }
+
+    return git_oid_equal(git_tree_id(act->get_tree()), &old_tree) != 0;
+}
+
+void RebaseViewWidget::updateConflicts(Action* start, Action* converge) {
+    // NOTE: The ranges are merged by the positions after the last edit. The earlier start and the later converge
+    // cover both edits, nullptr covers the whole plan.
+    if (m_recompute.pending) {
+        if (m_recompute.start == nullptr
+            || (start != nullptr
+                && m_actions.get_action_index(m_recompute.start) < m_actions.get_action_index(start))) {
+            start = m_recompute.start;
+        }
+
+        if (m_recompute.converge == nullptr
+            || (converge != nullptr
+                && m_actions.get_action_index(m_recompute.converge) > m_actions.get_action_index(converge))) {
+            converge = m_recompute.converge;
+        }
+    }
+
+    m_recompute.start    = start;
+    m_recompute.converge = converge;
+    m_recompute.pending  = true;
+
+    // every row from the first changed action on may get a different result
+    const int first = (start != nullptr) ? static_cast<int>(m_actions.get_action_index(start)) : 0;
+    for (int row = first; row < m_list_actions->count(); ++row) {
+        auto* item = getListItem(row);
+        if (item != nullptr) {
+            item->setPending(true);
+        }
+    }
+
+    // restarted by every edit, the replay runs once the edits stop
+    m_recompute_timer->start();
+}
+
+void RebaseViewWidget::flushConflicts() {
+    if (!m_recompute.pending) {
+        return;
+    }
 
+    Action* start    = m_recompute.start;
+    Action* converge = m_recompute.converge;
+
+    cancelRecompute();
+
+    LOG_INFO("Replaying scheduled changes");
+
+    // the plan was edited during the scan, the scan continues from the first affected action
+    if (m_scan.running) {
+        if (start != nullptr && m_scan.next != nullptr
+            && m_actions.get_action_index(m_scan.next) < m_actions.get_action_index(start)) {
+            start = m_scan.next;
+        }
+
+        scanConflicts(start);
+    } else {
+        updateConflictList(start, converge);
+        updateConflictMarkers();
+    }
+
+    updateGraph();
+}
+
+void RebaseViewWidget::cancelRecompute() {
+    m_recompute_timer->stop();
+    m_recompute = {};
+}
+
+void RebaseViewWidget::updateConflictList(Action* start, Action* converge) {
+    LOG_INFO("Updating conflict list");
+
+    // the scan is replaced by the synchronous replay
+    m_scan.running = false;
+
+    beginConflictScan(start, converge);
+    while (stepConflictScan()) { }
+
+    auto& merge_cache = conflict::MergeCache::get();
+    LOG_INFO(
+        "Merge cache: {} hits, {} misses, {} entries", merge_cache.hits(), merge_cache.misses(), merge_cache.size()
+    );
+}
+
+void RebaseViewWidget::beginConflictScan(Action* start, Action* converge) {
     Action* parent = nullptr;
 
     if (start == nullptr) {
@@ -285,33 +481,196 @@ void RebaseViewWidget::updateConflictList(Action* start) {
         }
     }
 
-    LOG_INFO("Updating conflict list");
-
     // prepare conflict widget
     m_conflict_widget->clearConflicts();
     m_conflict_paths.clear();
     m_conflict_entries.clear();
     m_conflict_files.clear();
 
+    // pending slices of the previous scan are ignored
+    m_scan.generation += 1;
+    m_scan.next         = start;
+    m_scan.parent       = parent;
+    m_scan.converge     = converge;
+    m_scan.can_converge = false;
+}
+
+bool RebaseViewWidget::stepConflictScan() {
+    using conflict::ConflictStatus;
+
+    Action* act = m_scan.next;
+    if (act == nullptr) {
+        return false;
+    }
+
+    m_scan.next         = act->get_next();
+    m_scan.can_converge = m_scan.can_converge || act == m_scan.converge;
+
+    // remember the previous result
+    const ConflictStatus old_status = act->get_tree_status();
+
+    git_oid old_tree = {};
+    if (act->get_tree() != nullptr) {
+        git_oid_cpy(&old_tree, git_tree_id(act->get_tree()));
+    }
+
+    // clear the resulting tree
+    act->clear_tree();
+
+    act->set_tree_status(updateConflictAction(act, m_scan.parent));
+
+    switch (act->get_type()) {
+    case action::ActionType::PICK:
+    case action::ActionType::REWORD:
+    case action::ActionType::EDIT:
+    case action::ActionType::SQUASH:
+    case action::ActionType::FIXUP:
+        m_scan.parent = act;
+        break;
+
+    case action::ActionType::DROP:
+        return true;
+    }
+
+    // the rest of the plan is replayed onto the same tree
+    if (m_scan.can_converge && has_same_result(act, old_status, old_tree)) {
+        LOG_INFO("Conflict list converged at action {}", getActionsManager().get_action_index(act));
+
+        refreshLastConflict(act->get_next());
+        m_scan.next = nullptr;
+    }
+
+    return true;
+}
+
+void RebaseViewWidget::scanConflicts(Action* start) {
+    LOG_INFO("Starting conflict scan");
+
+    beginConflictScan(start, nullptr);
+    m_scan.running = true;
+
+    continueConflictScan(m_scan.generation);
+}
+
+int RebaseViewWidget::lastPriorityRow() {
+    auto* viewport = m_list_actions->viewport();
+    int row        = m_list_actions->indexAt(viewport->rect().bottomLeft()).row();
+
+    // the list ends above the bottom of the viewport
+    if (row < 0) {
+        row = m_list_actions->count() - 1;
+    }
+
+    return std::max(row, m_list_actions->currentRow());
+}
+
+void RebaseViewWidget::continueConflictScan(std::uint64_t generation) {
+    // cancelled or replaced by another scan
+    if (!m_scan.running || generation != m_scan.generation) {
+        return;
+    }
+
+    // NOTE: Every action depends on all previous actions, so the visible and selected rows can not be replayed
+    // first. Instead the scan gets a longer time slice until it reaches them.
+    QElapsedTimer timer;
+    timer.start();
+
+    while (true) {
+        Action* act              = m_scan.next;
+        const int row            = (act != nullptr) ? static_cast<int>(m_actions.get_action_index(act)) : -1;
+        const std::int64_t slice = (row <= lastPriorityRow()) ? SCAN_PRIORITY_SLICE_MS : SCAN_SLICE_MS;
+
+        if (timer.elapsed() >= slice) {
+            break;
+        }
+
+        if (!stepConflictScan()) {
+            m_scan.running = false;
+
+            auto& merge_cache = conflict::MergeCache::get();
+            LOG_INFO(
+                "Conflict scan finished, merge cache: {} hits, {} misses, {} entries",
+                merge_cache.hits(),
+                merge_cache.misses(),
+                merge_cache.size()
+            );
+
+            updateConflictMarkers();
+            updateGraph();
+            return;
+        }
+
+        showConflictStatus(act);
+    }
+
+    QTimer::singleShot(0, this, [this, generation]() { continueConflictScan(generation); });
+}
+
+void RebaseViewWidget::showConflictStatus(Action* act) {
+    const int row = static_cast<int>(m_actions.get_action_index(act));
+    auto* item    = getListItem(row);
+
+    if (item == nullptr) {
+        return;
+    }
+
+    item->setConflict(act->get_tree_status());
+    item->setPending(false);
+
+    Node* node = item->getNode();
+    if (node == nullptr) {
+        return;
+    }
+
+    switch (act->get_type()) {
+    case ActionType::DROP:
+        return;
+
+    case ActionType::FIXUP:
+    case ActionType::SQUASH:
+        node->updateConflict(act->get_tree_status());
+        break;
+
+    case ActionType::PICK:
+    case ActionType::REWORD:
+    case ActionType::EDIT:
+        node->setConflict(act->get_tree_status());
+        break;
+    }
+
+    node->update();
+
+    if (row == m_list_actions->currentRow()) {
+        m_commit_view->update(node);
+    }
+}
+
+void RebaseViewWidget::refreshLastConflict(Action* start) {
+    using ConflictStatus = Action::ConflictStatus;
+
+    Action* last = nullptr;
+
     for (Action* act = start; act != nullptr; act = act->get_next()) {
-        // clear the resulting tree
-        act->clear_tree();
-
-        act->set_tree_status(updateConflictAction(act, parent));
-
-        switch (act->get_type()) {
-        case action::ActionType::PICK:
-        case action::ActionType::REWORD:
-        case action::ActionType::EDIT:
-        case action::ActionType::SQUASH:
-        case action::ActionType::FIXUP:
-            parent = act;
+        switch (act->get_tree_status()) {
+        case ConflictStatus::HAS_CONFLICT:
+        case ConflictStatus::RESOLVED_CONFLICT:
+            last = act;
             break;
 
-        case action::ActionType::DROP:
+        case ConflictStatus::UNKNOWN:
+        case ConflictStatus::ERR:
+        case ConflictStatus::NO_CONFLICT:
             break;
         }
     }
+
+    if (last == nullptr) {
+        return;
+    }
+
+    // the conflict widget shows the last conflict, merge it again to restore its state
+    last->clear_tree();
+    last->set_tree_status(updateConflictAction(last, action::ActionsManager::get_picked_parent(last)));
 }
 
 Action::ConflictStatus RebaseViewWidget::updateConflictAction(Action* act, Action* parent_act) {
@@ -321,6 +680,63 @@ Action::ConflictStatus RebaseViewWidget::updateConflictAction(Action* act, Actio
         return ConflictStatus::NO_CONFLICT;
     }
 
+    auto& merge_cache = conflict::MergeCache::get();
+
+    // the tree the commit is applied onto, missing if the parent has an unresolved conflict
+    git::tree_t parent_tree;
+    if (parent_act == nullptr) {
+        if (git_commit_tree(&parent_tree, getActionsManager().get_root_commit()) != 0) {
+            utils::log_libgit_error();
+            return ConflictStatus::UNKNOWN;
+        }
+    } else if (parent_act->get_tree() != nullptr) {
+        // only the reference count is increased
+        if (git_tree_dup(&parent_tree, parent_act->get_tree()) != 0) {
+            utils::log_libgit_error();
+            return ConflictStatus::UNKNOWN;
+        }
+    }
+
+    if (parent_tree.get() == nullptr) {
+        return ConflictStatus::UNKNOWN;
+    }
+
+    // dropping keeps the parent tree
+    if (act->get_type() == ActionType::DROP) {
+        act->set_tree(std::move(parent_tree), ConflictStatus::NO_CONFLICT);
+        return ConflictStatus::NO_CONFLICT;
+    }
+
+    const git_oid* parent_tree_id = git_tree_id(parent_tree);
+
+    auto cached = merge_cache.find(*parent_tree_id, act->get_oid(), act->get_type());
+
+    // conflicts are merged again, the index is required by the conflict widget
+    if (cached.has_value() && cached->status == ConflictStatus::NO_CONFLICT) {
+        git::tree_t tree;
+
+        if (git_tree_lookup(&tree, m_repo, &cached->tree) == 0) {
+            act->set_tree(std::move(tree), ConflictStatus::NO_CONFLICT);
+            return ConflictStatus::NO_CONFLICT;
+        }
+
+        utils::log_libgit_error();
+    }
+
+    // only the changed entries are merged, the full merge is needed for conflicts and moved files
+    if (!cached.has_value()) {
+        auto applied = conflict::apply_sparse(act, parent_tree);
+
+        git::tree_t tree;
+        if (applied.has_value() && git_tree_lookup(&tree, m_repo, &applied.value()) == 0) {
+            const conflict::MergeResult result { .tree = *applied, .status = ConflictStatus::NO_CONFLICT };
+            merge_cache.insert(*parent_tree_id, act->get_oid(), act->get_type(), result);
+
+            act->set_tree(std::move(tree), ConflictStatus::NO_CONFLICT);
+            return ConflictStatus::NO_CONFLICT;
+        }
+    }
+
     ConflictStatus conflict_status;
     git::index_t conflict_index;
 
@@ -358,11 +774,14 @@ Action::ConflictStatus RebaseViewWidget::updateConflictAction(Action* act, Actio
             return ConflictStatus::UNKNOWN;
         }
 
+        merge_cache.insert(*parent_tree_id, act->get_oid(), act->get_type(), { oid, ConflictStatus::NO_CONFLICT });
+
         // update the action tree
         act->set_tree(std::move(tree), Action::ConflictStatus::NO_CONFLICT);
         return ConflictStatus::NO_CONFLICT;
     }
     case ConflictStatus::HAS_CONFLICT:
+        merge_cache.insert(*parent_tree_id, act->get_oid(), act->get_type(), { {}, ConflictStatus::HAS_CONFLICT });
         break;
     }
 
@@ -384,12 +803,12 @@ Action::ConflictStatus RebaseViewWidget::updateConflictAction(Action* act, Actio
         conflict::ConflictEntry conflict_entry;
 
         if (entry.our != nullptr) {
-            conflict_entry.our_id = git_oid_tostr_s(&entry.our->id);
-            path                  = entry.our->path;
+            git_oid_cpy(&conflict_entry.our_id, &entry.our->id);
+            path = entry.our->path;
         }
 
         if (entry.their != nullptr) {
-            conflict_entry.their_id = git_oid_tostr_s(&entry.their->id);
+            git_oid_cpy(&conflict_entry.their_id, &entry.their->id);
 
             m_conflict_files.push_back(entry.their->id);
 
@@ -399,7 +818,7 @@ Action::ConflictStatus RebaseViewWidget::updateConflictAction(Action* act, Actio
         }
 
         if (entry.ancestor != nullptr) {
-            conflict_entry.ancestor_id = git_oid_tostr_s(&entry.ancestor->id);
+            git_oid_cpy(&conflict_entry.ancestor_id, &entry.ancestor->id);
 
             if (path == nullptr) {
                 path = entry.ancestor->path;
@@ -471,10 +890,10 @@ void RebaseViewWidget::moveAction(int from, int to) {
 
     Action* update_start = m_actions.move(from, to);
 
-    updateConflictList(update_start);
-    updateConflictMarkers();
+    // actions after both positions keep their parents
+    Action* converge = m_actions.get_action(static_cast<std::uint32_t>(std::max(from, to)))->get_next();
 
-    updateGraph();
+    updateConflicts(update_start, converge);
 }
 
 void RebaseViewWidget::moveSelectedAction(bool down) {
@@ -525,7 +944,7 @@ void RebaseViewWidget::changeActionType() {
     auto new_index      = static_cast<int>((index + 1) % ListItem::items.size());
     ActionType new_type = ListItem::items[new_index];
 
-    auto* cmd = new ListItemChangedCommand(m_list_actions, current, type, new_type);
+    auto* cmd = new ListItemChangedCommand(m_list_model, current, type, new_type);
 
     CommandHistory::Add(std::unique_ptr<ListItemChangedCommand>(cmd));
 
@@ -554,7 +973,7 @@ void RebaseViewWidget::changeActionType(ActionType type) {
     int index = ListItem::indexOf(old_type);
     assert(index >= 0);
 
-    auto* cmd = new ListItemChangedCommand(m_list_actions, current, old_type, type);
+    auto* cmd = new ListItemChangedCommand(m_list_model, current, old_type, type);
 
     CommandHistory::Add(std::unique_ptr<ListItemChangedCommand>(cmd));
 
@@ -623,6 +1042,11 @@ RebaseViewWidget::prepareGitGraph(git_repository* repo, const std::string& head,
 
     m_graph = std::move(graph_opt.value());
 
+    const auto& stats = m_graph.stats();
+    LOG_INFO(
+        "Loaded commits: {} from the commit-graph file, {} from the object database", stats.commit_graph, stats.odb
+    );
+
     std::uint32_t max_depth = m_graph.max_depth();
 
     Node* parent = nullptr;
@@ -631,7 +1055,7 @@ RebaseViewWidget::prepareGitGraph(git_repository* repo, const std::string& head,
 
         for (auto& node : nodes) {
             auto* commit_node = m_old_commits_graph->addNode(y);
-            commit_node->setCommit(node.commit);
+            commit_node->setCommitId(node.id);
 
             node.data = commit_node;
             node.data->setParentNode(parent);
@@ -650,11 +1074,21 @@ std::optional<std::string> RebaseViewWidget::update(
 ) {
     using git::CmdType;
 
+    // the scheduled actions are replaced
+    cancelRecompute();
+
     m_old_commits_graph->clear();
     m_actions.clear();
 
     m_repo = repo;
 
+    conflict::MergeCache::get().clear();
+    cancelMatrixUpdate();
+    conflict::CommuteMatrix::get().clear();
+    conflict::TouchIndex::get().clear();
+    git::DiffCache::get().clear();
+    git::CommitCache::get().attach(repo);
+
     auto err = prepareGitGraph(repo, head, onto);
     if (err.has_value()) {
         return err;
@@ -712,10 +1146,20 @@ std::optional<std::string> RebaseViewWidget::update(
 std::optional<std::string>
 RebaseViewWidget::update(git_repository* repo, const std::string& head, const std::string& onto) {
 
+    // the scheduled actions are replaced
+    cancelRecompute();
+
     m_old_commits_graph->clear();
 
     m_repo = repo;
 
+    conflict::MergeCache::get().clear();
+    cancelMatrixUpdate();
+    conflict::CommuteMatrix::get().clear();
+    conflict::TouchIndex::get().clear();
+    git::DiffCache::get().clear();
+    git::CommitCache::get().attach(repo);
+
     auto err = prepareGitGraph(repo, head, onto);
     if (err.has_value()) {
         return err;
@@ -727,33 +1171,359 @@ RebaseViewWidget::update(git_repository* repo, const std::string& head, const st
 
 void RebaseViewWidget::prepareActions() {
 
+    // the scheduled actions may have been freed
+    cancelRecompute();
+
     int last_selected_index = m_list_actions->currentRow();
     prepareGraph();
 
-    m_list_actions->clear();
+    // the statuses are filled in by the conflict scan
+    for (auto& action : m_actions) {
+        action.clear_tree();
+    }
 
-    updateConflictList(nullptr);
+    // NOTE: The rows hold only the state, they are painted by the delegate
+    m_list_model->setActions(m_actions);
 
-    auto* list = m_list_actions;
-    for (auto& action : m_actions) {
-        auto* action_item = new ListItem(this, list, list->count(), action);
+    for (int row = 0; row < m_list_model->count(); ++row) {
+        ListItem* item = getListItem(row);
+        prepareItem(item, item->getCommitAction());
+    }
+
+    if (last_selected_index != -1 && last_selected_index <= m_list_actions->count()) {
+        m_list_actions->setCurrentRow(last_selected_index);
+    }
+
+    updateCommuteMatrix();
+
+    scanConflicts(nullptr);
+}
 
-        prepareItem(action_item, action);
+void RebaseViewWidget::markDropTargets(int row) {
+    using DropTarget = ListItem::DropTarget;
 
-        auto* item = new QListWidgetItem();
+    auto* dragged = getListItem(row);
+    if (dragged == nullptr) {
+        return;
+    }
+
+    // commits created since the plan was loaded
+    updateCommuteMatrix();
+
+    const auto& matrix  = conflict::CommuteMatrix::get();
+    const Action& moved = dragged->getCommitAction();
+
+    auto is_known = [&matrix](const Action& act) {
+        return act.get_type() == ActionType::DROP || matrix.index_of(act.get_oid()).has_value();
+    };
+
+    // NOTE: Moving the action to a row swaps it with every action in between, dropped actions change nothing. Rows
+    // behind a commit that is not in the matrix yet are left unmarked until the matrix is updated.
+    auto mark = [&](int first, int last, int step) {
+        bool known    = is_known(moved);
+        bool commutes = true;
+
+        for (int i = first; i != last; i += step) {
+            ListItem* item = getListItem(i);
+            if (item == nullptr) {
+                continue;
+            }
+
+            const Action& other = item->getCommitAction();
+
+            known = known && is_known(other);
+
+            if (known && moved.get_type() != ActionType::DROP && other.get_type() != ActionType::DROP) {
+                commutes = commutes && matrix.can_commute(moved.get_oid(), other.get_oid());
+            }
+
+            if (!known) {
+                item->setDropTarget(DropTarget::NONE);
+            } else {
+                item->setDropTarget(commutes ? DropTarget::COMMUTES : DropTarget::CONFLICTS);
+            }
+        }
+    };
 
-        item->setSizeHint(action_item->sizeHint());
-        list->addItem(item);
-        list->setItemWidget(item, action_item);
+    mark(row - 1, -1, -1);
+    mark(row + 1, m_list_actions->count(), 1);
+}
+
+void RebaseViewWidget::clearDropTargets() {
+    for (int i = 0; i < m_list_actions->count(); ++i) {
+        ListItem* item = getListItem(i);
+
+        if (item != nullptr) {
+            item->setDropTarget(ListItem::DropTarget::NONE);
+        }
     }
+}
 
-    updateConflictMarkers();
+void RebaseViewWidget::updateCommuteMatrix() {
+    // the commits missing after the running update are collected once it finishes
+    if (m_matrix_task != nullptr) {
+        return;
+    }
 
-    if (last_selected_index == -1 || last_selected_index > m_list_actions->count()) {
+    auto commits = std::make_shared<std::vector<git_oid>>(conflict::CommuteMatrix::get().missing(m_actions));
+    if (commits->empty()) {
         return;
     }
 
-    m_list_actions->setCurrentRow(last_selected_index);
+    QPointer<RebaseViewWidget> widget = this;
+
+    m_matrix_task = git::TaskPool::get().submit(
+        git::TaskPriority::LOW,
+        [widget, commits](git_repository* repo, const std::shared_ptr<git::TaskToken>& token) {
+            // NOTE: The callback is owned by the token, so it keeps only a weak reference to it
+            token->on_progress([widget, weak_token = std::weak_ptr(token)](std::uint32_t done, std::uint32_t total) {
+                QMetaObject::invokeMethod(
+                    QCoreApplication::instance(),
+                    [widget, weak_token, done, total]() {
+                        auto token = weak_token.lock();
+                        if (widget == nullptr || token == nullptr || widget->m_matrix_task != token) {
+                            return;
+                        }
+
+                        emit widget->matrixProgress(done, total);
+                    },
+                    Qt::QueuedConnection
+                );
+            });
+
+            auto touched = conflict::CommuteMatrix::collect(repo, *commits, *token);
+            if (token->is_cancelled()) {
+                return;
+            }
+
+            std::shared_ptr<std::vector<conflict::TouchedCommit>> result;
+
+            if (touched.has_value()) {
+                result = std::make_shared<std::vector<conflict::TouchedCommit>>(std::move(touched.value()));
+            } else {
+                utils::log_libgit_error();
+            }
+
+            // NOTE: The pool outlives the widget, the result is posted to the application
+            QMetaObject::invokeMethod(
+                QCoreApplication::instance(),
+                [widget, token, result]() {
+                    if (widget == nullptr || token->is_cancelled()) {
+                        return;
+                    }
+
+                    widget->m_matrix_task = nullptr;
+                    emit widget->matrixProgress(0, 0);
+
+                    // the failed commits are diffed again by the next update
+                    if (result == nullptr) {
+                        return;
+                    }
+
+                    conflict::CommuteMatrix::get().add(std::move(*result));
+
+                    if (widget->m_drag_row != -1) {
+                        widget->markDropTargets(widget->m_drag_row);
+                    }
+
+                    // commits added while the matrix was updated
+                    widget->updateCommuteMatrix();
+                },
+                Qt::QueuedConnection
+            );
+        }
+    );
+}
+
+void RebaseViewWidget::cancelMatrixUpdate() {
+    if (m_matrix_task != nullptr) {
+        m_matrix_task->cancel();
+        m_matrix_task = nullptr;
+
+        emit matrixProgress(0, 0);
+    }
+}
+
+void RebaseViewWidget::cancelPreview() {
+    if (m_preview_task != nullptr) {
+        m_preview_task->cancel();
+        m_preview_task = nullptr;
+    }
+}
+
+void RebaseViewWidget::showPreviewResult(conflict::ConflictStatus status) {
+    using ConflictColor = style::ConflictStyle::Style;
+
+    switch (status) {
+    case conflict::ConflictStatus::NO_CONFLICT:
+    case conflict::ConflictStatus::RESOLVED_CONFLICT:
+        m_list_actions->setDropIndicatorColor(style::ConflictStyle::get_color(ConflictColor::COMMUTES));
+        break;
+    case conflict::ConflictStatus::HAS_CONFLICT:
+        m_list_actions->setDropIndicatorColor(style::ConflictStyle::get_color(ConflictColor::CONFLICT));
+        break;
+    case conflict::ConflictStatus::UNKNOWN:
+    case conflict::ConflictStatus::ERR:
+        m_list_actions->setDropIndicatorColor(QColor());
+        break;
+    }
+}
+
+void RebaseViewWidget::previewDrop(int target) {
+    using conflict::ConflictStatus;
+
+    cancelPreview();
+    showPreviewResult(ConflictStatus::UNKNOWN);
+
+    if (m_drag_row < 0 || target == m_drag_row) {
+        return;
+    }
+
+    const int first = std::min(m_drag_row, target);
+    const int last  = std::max(m_drag_row, target);
+
+    // the rows above the moved ones are not affected
+    git::tree_t root_tree;
+    git_tree* parent_tree = nullptr;
+
+    if (first == 0) {
+        if (git_commit_tree(&root_tree, m_actions.get_root_commit()) != 0) {
+            utils::log_libgit_error();
+            return;
+        }
+
+        parent_tree = root_tree;
+    } else if (ListItem* item = getListItem(first - 1); item != nullptr) {
+        parent_tree = item->getCommitAction().get_tree();
+    }
+
+    // the parent has an unresolved conflict
+    if (parent_tree == nullptr) {
+        return;
+    }
+
+    std::vector<conflict::ReplayStep> steps;
+    for (int i = first; i <= last; ++i) {
+        ListItem* item = getListItem(i);
+        if (item == nullptr) {
+            return;
+        }
+
+        const Action& act = item->getCommitAction();
+        steps.push_back({ .commit = act.get_oid(), .type = act.get_type(), .tree = {} });
+    }
+
+    if (m_drag_row < target) {
+        std::rotate(steps.begin(), steps.begin() + 1, steps.end());
+    } else {
+        std::rotate(steps.begin(), steps.end() - 1, steps.end());
+    }
+
+    // replay the cached part immediately
+    auto& merge_cache = conflict::MergeCache::get();
+    git_oid tree      = *git_tree_id(parent_tree);
+
+    std::size_t cached = 0;
+    for (; cached < steps.size(); ++cached) {
+        auto& step = steps[cached];
+
+        if (step.type == ActionType::DROP) {
+            continue;
+        }
+
+        auto result = merge_cache.find(tree, step.commit, step.type);
+        if (!result.has_value()) {
+            break;
+        }
+
+        // NOTE: The conflict may have recorded resolutions, the worker merges it again
+        if (result->status != ConflictStatus::NO_CONFLICT) {
+            break;
+        }
+
+        tree = result->tree;
+    }
+
+    if (cached == steps.size()) {
+        showPreviewResult(ConflictStatus::NO_CONFLICT);
+        return;
+    }
+
+    struct task_t {
+        git_oid tree;
+        std::vector<conflict::ReplayStep> steps;
+
+        // the result depends on the rows up to the last moved one
+        std::shared_ptr<const action::PlanSnapshot> snapshot;
+        std::size_t prefix;
+    };
+
+    auto task      = std::make_shared<task_t>();
+    task->tree     = tree;
+    task->steps    = std::vector(steps.begin() + static_cast<std::ptrdiff_t>(cached), steps.end());
+    task->snapshot = m_actions.snapshot();
+    task->prefix   = static_cast<std::size_t>(last) + 1;
+
+    QPointer<RebaseViewWidget> widget = this;
+
+    m_preview_task = git::TaskPool::get().submit(
+        git::TaskPriority::NORMAL,
+        [widget, task](git_repository* repo, const std::shared_ptr<git::TaskToken>& token) {
+            const bool replayed = conflict::replay_detached(
+                repo, task->tree, task->steps, task->snapshot->resolutions().conflicts, token->flag()
+            );
+
+            // NOTE: The pool outlives the widget, the result is posted to the application
+            QMetaObject::invokeMethod(
+                QCoreApplication::instance(),
+                [widget, task, token, replayed]() {
+                    if (widget == nullptr || token->is_cancelled()) {
+                        return;
+                    }
+
+                    widget->m_preview_task = nullptr;
+
+                    // the results are reused once the action is dropped
+                    auto& merge_cache     = conflict::MergeCache::get();
+                    git_oid parent        = task->tree;
+                    ConflictStatus status = replayed ? ConflictStatus::NO_CONFLICT : ConflictStatus::UNKNOWN;
+
+                    for (auto&& step : task->steps) {
+                        if (step.status == ConflictStatus::UNKNOWN || step.status == ConflictStatus::ERR) {
+                            break;
+                        }
+
+                        // the cache stores only the merge, resolved conflicts are applied again
+                        if (step.status == ConflictStatus::RESOLVED_CONFLICT) {
+                            merge_cache.insert(parent, step.commit, step.type, { {}, ConflictStatus::HAS_CONFLICT });
+
+                            if (status == ConflictStatus::NO_CONFLICT) {
+                                status = ConflictStatus::RESOLVED_CONFLICT;
+                            }
+                        } else if (step.type != ActionType::DROP) {
+                            merge_cache.insert(parent, step.commit, step.type, { step.tree, step.status });
+                        }
+
+                        // the replay stopped at the conflict
+                        if (step.status == ConflictStatus::HAS_CONFLICT) {
+                            status = ConflictStatus::HAS_CONFLICT;
+                            break;
+                        }
+
+                        parent = step.tree;
+                    }
+
+                    // NOTE: The merge results do not depend on the plan, but the status does
+                    if (!widget->m_actions.is_current(*task->snapshot, task->prefix)) {
+                        status = ConflictStatus::UNKNOWN;
+                    }
+
+                    widget->showPreviewResult(status);
+                },
+                Qt::QueuedConnection
+            );
+        }
+    );
 }
 
 void RebaseViewWidget::prepareGraph() {
@@ -763,9 +1533,9 @@ void RebaseViewWidget::prepareGraph() {
     auto& last_node = m_graph.first_node();
     m_root_node     = last_node.data;
 
-    last->setCommit(last_node.commit);
+    last->setCommitId(last_node.id);
 
-    m_actions.set_root_commit(last_node.commit);
+    m_actions.set_root_commit(m_graph.root_commit());
 
     m_last_node = last;
 
@@ -795,6 +1565,7 @@ void RebaseViewWidget::updateGraph() {
 
         Action& act = item->getCommitAction();
         item->setConflict(act.get_tree_status());
+        item->setPending(false);
 
         switch (act.get_type()) {
         case ActionType::DROP:
@@ -812,7 +1583,7 @@ void RebaseViewWidget::updateGraph() {
         case ActionType::REWORD:
         case ActionType::EDIT: {
             Node* new_node = m_new_commits_graph->addNode();
-            new_node->setCommit(act.get_commit());
+            new_node->setCommitId(act.get_oid());
             new_node->setParentNode(m_last_node);
             new_node->setAction(&act);
 
@@ -841,43 +1612,23 @@ void RebaseViewWidget::updateGraph() {
     m_commit_view->update(node);
 }
 
-Node* RebaseViewWidget::findOldCommit(const git_oid& oid) {
-    git::commit_t commit;
-
-    if (git_commit_lookup(&commit, m_repo, &oid) != 0) {
-        return nullptr;
-    }
-
-    return m_old_commits_graph->find([&](const Node* node) { return git_oid_equal(node->getCommitId(), &oid) != 0; });
-}
+Node* RebaseViewWidget::findOldCommit(const git_oid& oid) { return m_old_commits_graph->find(oid); }
 
 void RebaseViewWidget::prepareItem(ListItem* item, Action& action) {
-    QString item_text;
     item->setConflict(action.get_tree_status());
 
     switch (action.get_type()) {
     case ActionType::DROP: {
-        Node* old = findOldCommit(action.get_oid());
         item->setNode(m_last_node);
-
-        if (old != nullptr) {
-            item_text += git_commit_summary(old->getCommit());
-        } else {
-            item_text += git_commit_summary(action.get_commit());
-        }
         break;
     }
 
     case ActionType::FIXUP:
     case ActionType::SQUASH: {
-        Node* old = findOldCommit(action.get_oid());
-        if (old != nullptr) {
+        if (findOldCommit(action.get_oid()) != nullptr) {
             m_last_node->updateConflict(action.get_tree_status());
-
-            item_text += git_commit_summary(old->getCommit());
-        } else {
-            item_text += git_commit_summary(action.get_commit());
         }
+
         item->setNode(m_last_node);
         break;
     }
@@ -885,16 +1636,8 @@ void RebaseViewWidget::prepareItem(ListItem* item, Action& action) {
     case ActionType::PICK:
     case ActionType::REWORD:
     case ActionType::EDIT: {
-
-        Node* old = findOldCommit(action.get_oid());
-        if (old != nullptr) {
-            item_text += git_commit_summary(old->getCommit());
-        } else {
-            item_text += git_commit_summary(action.get_commit());
-        }
-
         Node* new_node = m_new_commits_graph->addNode();
-        new_node->setCommit(action.get_commit());
+        new_node->setCommitId(action.get_oid());
         new_node->setParentNode(m_last_node);
         new_node->setAction(&action);
 
@@ -905,11 +1648,11 @@ void RebaseViewWidget::prepareItem(ListItem* item, Action& action) {
         break;
     }
     }
-
-    item->setText(item_text);
 }
 
 void RebaseViewWidget::checkoutAndResolve() {
+    // the resolved action must have the current result
+    flushConflicts();
 
     // 1. Check if working index is clean
     {
@@ -979,6 +1722,18 @@ void RebaseViewWidget::checkoutAndResolve() {
             return;
         }
 
+        // the working directory is resolved outside of the application
+        std::vector<git_oid> objects = { commit_id };
+        for (std::size_t i = 0; i < git_index_entrycount(m_conflict_index); ++i) {
+            objects.push_back(git_index_get_byindex(m_conflict_index, i)->id);
+        }
+
+        if (!git::MemPack::get().flush(objects)) {
+            utils::log_libgit_error();
+            QMessageBox::critical(this, "Failed to write objects", QString::fromStdString(git::get_last_error()));
+            return;
+        }
+
         if (!git::set_repository_head_detached(m_repo, &commit_id)) {
             utils::log_libgit_error();
             QMessageBox::critical(this, "Repo head error", QString::fromStdString(git::get_last_error()));
@@ -1103,9 +1858,9 @@ bool RebaseViewWidget::markResolved() {
         tree_id                 = git_commit_tree_id(root_commit);
     }
 
-    auto& conflict_manager  = conflict::ConflictManager::get();
-    conflict.commit_id      = git::format_oid_to_str<git::OID_SIZE>(&m_cherrypick->get_oid());
-    conflict.parent_tree_id = git::format_oid_to_str<git::OID_SIZE>(tree_id);
+    auto& conflict_manager = conflict::ConflictManager::get();
+    git_oid_cpy(&conflict.commit_id, &m_cherrypick->get_oid());
+    git_oid_cpy(&conflict.parent_tree_id, tree_id);
 
     conflict_manager.add_trees_resolution(conflict, std::move(tree));
 
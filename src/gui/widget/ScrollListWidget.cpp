@@ -1,10 +1,17 @@
 #include "gui/widget/ScrollListWidget.h"
 
+#include <QColor>
 #include <QDragMoveEvent>
-#include <QListWidget>
+#include <QKeyEvent>
+#include <QListView>
+#include <QModelIndex>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QPen>
 #include <QPoint>
 #include <QRect>
 #include <QScrollBar>
+#include <Qt>
 #include <QTimer>
 #include <QtMinMax>
 #include <QWidget>
@@ -12,7 +19,7 @@
 namespace gui::widget {
 
 ScrollListWidget::ScrollListWidget(QWidget* parent)
-    : QListWidget(parent)
+    : QListView(parent)
     , m_dir(ScrollDirection::NONE) {
 
     m_timer = new QTimer(this);
@@ -21,12 +28,64 @@ ScrollListWidget::ScrollListWidget(QWidget* parent)
     connect(m_timer, &QTimer::timeout, this, &ScrollListWidget::autoScroll);
 }
 
+void ScrollListWidget::startDrag(Qt::DropActions supported_actions) {
+    m_drag_row   = currentRow();
+    m_target_row = m_drag_row;
+    emit dragStarted(m_drag_row);
+
+    // blocks until the item is dropped or the drag is cancelled
+    QListView::startDrag(supported_actions);
+
+    m_drag_row   = -1;
+    m_target_row = -1;
+    m_drop_y     = -1;
+    m_drop_color = QColor();
+    emit dragFinished();
+}
+
+void ScrollListWidget::setDropIndicatorColor(const QColor& color) {
+    m_drop_color = color;
+    viewport()->update();
+}
+
+void ScrollListWidget::updateDropTarget(const QPoint& pos) {
+    if (m_drag_row < 0) {
+        return;
+    }
+
+    // the item is inserted before this row
+    int row                 = count();
+    const QModelIndex index = indexAt(pos);
+
+    if (index.isValid()) {
+        const QRect item_rect = visualRect(index);
+        row                   = (pos.y() < item_rect.center().y()) ? index.row() : index.row() + 1;
+        m_drop_y              = (row == index.row()) ? item_rect.top() : item_rect.bottom();
+    } else if (count() > 0) {
+        m_drop_y = visualRect(model()->index(count() - 1, 0)).bottom();
+    }
+
+    // the item is removed from its row first
+    if (row > m_drag_row) {
+        row -= 1;
+    }
+
+    viewport()->update();
+
+    if (row != m_target_row) {
+        m_target_row = row;
+        emit dragTargetChanged(row);
+    }
+}
+
 void ScrollListWidget::dragMoveEvent(QDragMoveEvent* event) {
-    QListWidget::dragMoveEvent(event);
+    QListView::dragMoveEvent(event);
 
     const QRect widget_rect = rect();
     const QPoint pos        = event->position().toPoint();
 
+    updateDropTarget(pos);
+
     int bottom_margin = SCROLL_MARGIN;
     if (horizontalScrollBar()->isVisible()) {
         bottom_margin += horizontalScrollBar()->height();
@@ -49,7 +108,7 @@ void ScrollListWidget::dragMoveEvent(QDragMoveEvent* event) {
 }
 
 void ScrollListWidget::dragLeaveEvent(QDragLeaveEvent* event) {
-    QListWidget::dragLeaveEvent(event);
+    QListView::dragLeaveEvent(event);
     m_timer->stop();
     m_dir = ScrollDirection::NONE;
 }
@@ -57,7 +116,31 @@ void ScrollListWidget::dragLeaveEvent(QDragLeaveEvent* event) {
 void ScrollListWidget::dropEvent(QDropEvent* event) {
     m_timer->stop();
     m_dir = ScrollDirection::NONE;
-    QListWidget::dropEvent(event);
+    QListView::dropEvent(event);
+}
+
+void ScrollListWidget::paintEvent(QPaintEvent* event) {
+    QListView::paintEvent(event);
+
+    if (m_drag_row < 0 || m_drop_y < 0 || !m_drop_color.isValid()) {
+        return;
+    }
+
+    QPainter painter(viewport());
+    painter.setPen(QPen(m_drop_color, DROP_LINE_WIDTH));
+    painter.drawLine(0, m_drop_y, viewport()->width(), m_drop_y);
+}
+
+void ScrollListWidget::keyPressEvent(QKeyEvent* event) {
+    // the current item is edited by the enter key
+    const int key = event->key();
+
+    if ((key == Qt::Key_Enter || key == Qt::Key_Return) && state() != EditingState && currentIndex().isValid()) {
+        edit(currentIndex());
+        return;
+    }
+
+    QListView::keyPressEvent(event);
 }
 
 void ScrollListWidget::autoScroll() {
@@ -120,12 +120,14 @@ void SettingsDialog::setupColors() {
         auto* conflict_conflict = create_color_picker<ConflictStyle>("Conflict", ConflictStyle::CONFLICT);
         auto* conflict_resolved = create_color_picker<ConflictStyle>("Resolved conflict", ConflictStyle::RESOLVED_CONFLICT);
         auto* conflict_unknown  = create_color_picker<ConflictStyle>("Unknown", ConflictStyle::UNKNOWN);
+        auto* conflict_commutes = create_color_picker<ConflictStyle>("Commutes", ConflictStyle::COMMUTES);
         // clang-format on
 
         conflict_colors_layout->addRow("Normal:", conflict_normal);
         conflict_colors_layout->addRow("Conflict:", conflict_conflict);
         conflict_colors_layout->addRow("Resolved:", conflict_resolved);
         conflict_colors_layout->addRow("Unknown:", conflict_unknown);
+        conflict_colors_layout->addRow("Safe move:", conflict_commutes);
 
         color_layout->addWidget(conflict_colors_group);
     }
@@ -1,16 +1,22 @@
 #include "gui/widget/graph/Graph.h"
 
+#include "gui/style/ConflictStyle.h"
+#include "gui/style/GlobalStyle.h"
+#include "gui/style/StyleManager.h"
 #include "gui/widget/graph/Node.h"
 
 #include <algorithm>
 #include <cstdint>
 #include <functional>
 
-#include <QGraphicsScene>
-#include <QGraphicsSceneMouseEvent>
-#include <QGraphicsView>
+#include <git2/oid.h>
+
+#include <QAbstractScrollArea>
 #include <QMouseEvent>
 #include <QPainter>
+#include <QPaintEvent>
+#include <QRect>
+#include <QResizeEvent>
 #include <QScrollBar>
 #include <Qt>
 #include <QtTypes>
@@ -18,116 +24,163 @@
 namespace gui::widget {
 
 GraphWidget::GraphWidget(QWidget* parent)
-    : QGraphicsView(parent) {
-
-    auto* scene = new QGraphicsScene(this);
-    scene->setItemIndexMethod(QGraphicsScene::NoIndex);
-    scene->setSceneRect(0, 0, 100, 100);
-    setScene(scene);
+    : QAbstractScrollArea(parent) {
 
-    setRenderHint(QPainter::RenderHint::Antialiasing);
-    setTransformationAnchor(AnchorUnderMouse);
-    setAlignment(Qt::AlignLeft | Qt::AlignTop);
     setVerticalScrollBarPolicy(Qt::ScrollBarPolicy::ScrollBarAlwaysOn);
     setHorizontalScrollBarPolicy(Qt::ScrollBarPolicy::ScrollBarAsNeeded);
-
-    scale(qreal(0.95), qreal(0.95));
     setViewportMargins(0, 0, 10, 0);
-}
 
-Node* GraphWidget::addNode(std::uint32_t y) {
-    auto* node = new Node(this);
+    verticalScrollBar()->setSingleStep(ROW_HEIGHT);
 
-    auto scene_rect  = mapToScene(viewport()->rect()).boundingRect();
-    auto scene_width = scene_rect.width();
-    node->setWidth(scene_width);
+    // NOTE: The nodes are painted by the widget, a style change repaints only the viewport
+    connect(&style::StyleManager::get_conflict_style(), &style::ConflictStyle::changed, this, [this]() {
+        viewport()->update();
+    });
 
-    scene()->addItem(node);
+    connect(&style::StyleManager::get_global_style(), &style::GlobalStyle::changed, this, [this]() {
+        viewport()->update();
+    });
+}
 
-    auto node_height = node->boundingRect().height();
-    auto node_width  = node->boundingRect().width();
+Node* GraphWidget::addNode(std::uint32_t y) {
+    Node* node = &m_nodes.emplace_back(this, y);
 
-    auto padding = 2;
-    auto gap     = 2;
-    auto pos_y   = y * (node_height + gap);
+    if (y >= m_rows.size()) {
+        m_rows.resize(y + 1, nullptr);
+    }
 
-    node->setPos(padding, pos_y + gap);
+    m_rows[y] = node;
 
     m_next_y = std::max<std::uint32_t>(y + 1, m_next_y);
 
-    double new_height = ((y + 1) * (node_height + gap)) + gap;
-    double new_width  = node_width + padding;
-
-    double curr_height = sceneRect().height();
-    double curr_width  = sceneRect().width();
-
-    auto rect = sceneRect();
-    rect.setHeight(std::max(new_height, curr_height));
-    rect.setWidth(std::max(new_width, curr_width));
-
-    setSceneRect(rect);
-
-    m_nodes.push_back(node);
+    updateScrollBars();
+    updateNode(node);
 
     return node;
 }
 
 Node* GraphWidget::addNode() { return addNode(m_next_y); }
 
-Node* GraphWidget::find(std::function<bool(const Node*)> prec) {
-    for (auto* node : m_nodes) {
-        if (prec(node)) {
-            return node;
-        }
+Node* GraphWidget::find(const git_oid& id) {
+    const std::uint32_t* row = m_index.find(id);
+    if (row == nullptr) {
+        return nullptr;
     }
 
-    return nullptr;
+    return m_rows[*row];
 }
 
 void GraphWidget::clear() {
+    m_selected = nullptr;
 
+    m_index.clear();
+    m_rows.clear();
     m_nodes.clear();
 
-    for (auto* item : scene()->items()) {
-        scene()->removeItem(item);
-        delete item;
-    }
     m_next_y = 0;
+
+    updateScrollBars();
+    viewport()->update();
+}
+
+void GraphWidget::updateNode(const Node* node) {
+    QRect rect = rowRect(node->getRow());
+
+    if (rect.intersects(viewport()->rect())) {
+        viewport()->update(rect);
+    }
+}
+
+void GraphWidget::indexNode(const Node* node) { m_index.insert_or_assign(*node->getCommitId(), node->getRow()); }
+
+QRect GraphWidget::rowRect(std::uint32_t row) const {
+    const int y = (static_cast<int>(row) * ROW_HEIGHT) + GAP - verticalScrollBar()->value();
+    const int x = PADDING - horizontalScrollBar()->value();
+
+    return { x, y, rowsWidth(), static_cast<int>(Node::HEIGHT) };
+}
+
+int GraphWidget::rowsWidth() const {
+    return std::max(viewport()->width() - PADDING, static_cast<int>(Node::MIN_WIDTH));
+}
+
+void GraphWidget::updateScrollBars() {
+    const int height = (static_cast<int>(m_rows.size()) * ROW_HEIGHT) + GAP;
+    const int width  = rowsWidth() + PADDING;
+
+    verticalScrollBar()->setPageStep(viewport()->height());
+    verticalScrollBar()->setRange(0, std::max(0, height - viewport()->height()));
+
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setRange(0, std::max(0, width - viewport()->width()));
 }
 
 void GraphWidget::mousePressEvent(QMouseEvent* event) {
-    // HACK: Rather than manually managing focus, retrieve the currently focused item, handle the mouse press, and
-    // determine the new focused item.
+    Node* old_node = m_selected;
+    Node* new_node = nullptr;
 
-    auto* old_item = scene()->focusItem();
+    // the row under the cursor, the gaps between the rows select nothing
+    const int y = static_cast<int>(event->position().y()) + verticalScrollBar()->value() - GAP;
 
-    QGraphicsView::mousePressEvent(event);
+    if (y >= 0 && y % ROW_HEIGHT < static_cast<int>(Node::HEIGHT)) {
+        const auto row = static_cast<std::uint32_t>(y / ROW_HEIGHT);
 
-    auto* new_item = scene()->focusItem();
+        if (row < m_rows.size() && rowRect(row).contains(event->position().toPoint())) {
+            new_node = m_rows[row];
+        }
+    }
 
-    auto* old_node = dynamic_cast<Node*>(old_item);
-    auto* new_node = dynamic_cast<Node*>(new_item);
+    m_selected = new_node;
+
+    if (old_node != nullptr) {
+        updateNode(old_node);
+    }
+
+    if (new_node != nullptr) {
+        updateNode(new_node);
+    }
 
     m_handle(old_node, new_node);
 }
 
 void GraphWidget::resizeEvent(QResizeEvent* event) {
-    QGraphicsView::resizeEvent(event);
+    QAbstractScrollArea::resizeEvent(event);
 
-    auto* s = scene();
+    // NOTE: The rows take the width of the viewport when painted
+    updateScrollBars();
+}
 
-    if (s == nullptr) {
+void GraphWidget::scrollContentsBy(int /*dx*/, int /*dy*/) { viewport()->update(); }
+
+void GraphWidget::paintEvent(QPaintEvent* /*event*/) {
+    if (m_rows.empty()) {
         return;
     }
-    auto scene_rect  = mapToScene(viewport()->rect()).boundingRect();
-    auto scene_width = std::max(scene_rect.width(), Node::MIN_WIDTH);
 
-    auto rect = sceneRect();
-    rect.setWidth(scene_width);
-    setSceneRect(rect);
+    QPainter painter(viewport());
+    painter.setRenderHint(QPainter::RenderHint::Antialiasing);
+
+    const int top    = std::max(0, verticalScrollBar()->value() - GAP);
+    const int bottom = verticalScrollBar()->value() + viewport()->height();
+
+    const auto count = static_cast<std::uint32_t>(m_rows.size());
+    const auto first = static_cast<std::uint32_t>(top / ROW_HEIGHT);
+    const auto last  = std::min(static_cast<std::uint32_t>(bottom / ROW_HEIGHT) + 1, count);
+
+    const qreal width = rowsWidth();
+
+    for (std::uint32_t row = first; row < last; ++row) {
+        Node* node = m_rows[row];
+        if (node == nullptr) {
+            continue;
+        }
+
+        const QRect rect = rowRect(row);
 
-    for (auto* node : m_nodes) {
-        node->setWidth(scene_width);
+        painter.save();
+        painter.translate(rect.topLeft());
+        node->paint(&painter, width, node == m_selected);
+        painter.restore();
     }
 }
 
@@ -1,38 +1,43 @@
 #include "gui/widget/graph/Node.h"
 
 #include "action/ActionManager.h"
+#include "git/CommitCache.h"
+#include "git/types.h"
 #include "gui/style/ConflictStyle.h"
 #include "gui/style/GlobalStyle.h"
-#include "gui/style/StyleManager.h"
+#include "gui/widget/graph/Graph.h"
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <string>
 
+#include <git2/commit.h>
+#include <git2/oid.h>
+
 #include <QColor>
 #include <QFont>
 #include <QFontDatabase>
-#include <QGraphicsItem>
 #include <QPainter>
 #include <QPen>
 #include <QString>
-#include <QStyleOptionGraphicsItem>
 #include <Qt>
 #include <QTextOption>
 #include <QtTypes>
-#include <QWidget>
 
 namespace gui::widget {
 
-Node::Node(GraphWidget* graph)
-    : m_graph(graph) {
-    setFlags(QGraphicsItem::ItemIsSelectable | QGraphicsItem::ItemIsFocusable);
-
-    connect(&style::StyleManager::get_conflict_style(), &style::ConflictStyle::changed, this, [this]() { update(); });
+Node::Node(GraphWidget* graph, std::uint32_t row)
+    : m_graph(graph)
+    , m_row(row) { }
 
-    connect(&style::StyleManager::get_global_style(), &style::GlobalStyle::changed, this, [this]() { update(); });
+void Node::setCommitId(const git_oid& id) {
+    git_oid_cpy(&m_commit_id, &id);
+    m_graph->indexNode(this);
 }
 
+void Node::update() { m_graph->updateNode(this); }
+
 void Node::updateConflict(ConflictStatus conflict) {
     switch (m_conflict) {
     case ConflictStatus::ERR:
@@ -46,26 +51,12 @@ void Node::updateConflict(ConflictStatus conflict) {
     }
 }
 
-void Node::setWidth(qreal width) {
-    prepareGeometryChange();
-    m_width = std::max(MIN_WIDTH, width);
-    update();
-}
-
-QRectF Node::boundingRect() const { return { 0, 0, m_width, HEIGHT }; }
-
-QPainterPath Node::shape() const {
-    QPainterPath path;
-    path.addRect(0, 0, m_width, HEIGHT);
-    return path;
-}
-
 void Node::setFill(const QColor& color) {
     m_fill = color;
     update();
 }
 
-void Node::paint(QPainter* painter, const QStyleOptionGraphicsItem* /*option*/, QWidget* /*widget*/) {
+void Node::paint(QPainter* painter, qreal width, bool is_selected) {
     using ConflictColor = style::ConflictStyle::Style;
 
     constexpr int PADDING       = 2;
@@ -96,13 +87,11 @@ void Node::paint(QPainter* painter, const QStyleOptionGraphicsItem* /*option*/,
         break;
     }
 
-    const bool is_selected = hasFocus();
-
     if (draw_box || is_selected) {
         auto brush = QBrush(color);
         painter->setBrush(brush);
         painter->setPen(Qt::PenStyle::NoPen);
-        painter->drawRect(HASH_BOX_SIZE, 0, m_width - TEXT_OFFSET, HEIGHT);
+        painter->drawRect(HASH_BOX_SIZE, 0, width - TEXT_OFFSET, HEIGHT);
     }
 
     QFont font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
@@ -126,7 +115,13 @@ void Node::paint(QPainter* painter, const QStyleOptionGraphicsItem* /*option*/,
     // reset brush
     painter->setBrush(m_fill);
 
-    std::string msg = m_commit_msg;
+    // NOTE: The commit is parsed only once the node is painted
+    std::string msg;
+
+    if (git_commit* commit = getCommit(); commit != nullptr) {
+        const char* summary = git_commit_summary(commit);
+        msg                 = (summary != nullptr) ? summary : "";
+    }
 
     if (m_action != nullptr && m_action->has_msg()) {
         auto id = m_action->get_msg_id();
@@ -140,7 +135,7 @@ void Node::paint(QPainter* painter, const QStyleOptionGraphicsItem* /*option*/,
         }
     }
 
-    const char* hash = m_commit_hash.c_str();
+    const auto hash = git::format_oid(&m_commit_id);
 
     painter->drawText(
         QRectF {
@@ -149,7 +144,7 @@ void Node::paint(QPainter* painter, const QStyleOptionGraphicsItem* /*option*/,
             HASH_BOX_SIZE - PADDING,
             HEIGHT,
         },
-        hash,
+        hash.data(),
         text_opts
     );
 
@@ -159,7 +154,7 @@ void Node::paint(QPainter* painter, const QStyleOptionGraphicsItem* /*option*/,
 
     QString qmsg = QString::fromStdString(msg);
 
-    const qreal text_size = m_width - TEXT_OFFSET - PADDING;
+    const qreal text_size = width - TEXT_OFFSET - PADDING;
 
     if (size > text_size) {
         int new_size = static_cast<int>((text_size + avg_char_size - 1) / avg_char_size);
@@ -5,6 +5,7 @@
 #include "utils/todo.h"
 
 #include <iostream>
+#include <string>
 
 #include <QMessageBox>
 #include <QString>
@@ -56,8 +57,10 @@ bool PatchSplitter::file_begin(const diff_files_header_t& header, FileState stat
 void PatchSplitter::prepare_header() {
     using State = diff_files_t::State;
 
-    auto old_file = "a/" + m_header->old_file.path;
-    auto new_file = "b/" + m_header->new_file.path;
+    std::string old_file = "a/";
+    std::string new_file = "b/";
+    old_file += m_header->old_file.path;
+    new_file += m_header->new_file.path;
 
     m_file_header << "diff --git " << old_file << ' ' << new_file << '\n';
 
@@ -174,6 +174,26 @@ bool load_actions(QDomElement& root, SaveData& save_data, git_repository* repo)
     return true;
 }
 
+// NOTE: A missing side of a conflict is stored as an empty string
+QString oid_to_attribute(const git_oid& oid) {
+    if (git_oid_is_zero(&oid) != 0) {
+        return {};
+    }
+
+    return QString::fromStdString(git::format_oid_to_str<git::OID_SIZE>(&oid));
+}
+
+bool attribute_to_oid(const QDomElement& element, const char* name, git_oid& oid) {
+    std::string value = element.attribute(name).toStdString();
+
+    if (value.empty()) {
+        oid = {};
+        return true;
+    }
+
+    return git_oid_fromstr(&oid, value.c_str()) == 0;
+}
+
 void save_conflicts(QDomElement& root, QDomDocument& doc) {
     auto& manager = conflict::ConflictManager::get();
 
@@ -182,10 +202,10 @@ void save_conflicts(QDomElement& root, QDomDocument& doc) {
     for (auto&& [entry, blob] : manager.get_conflicts()) {
         QDomElement conflict = doc.createElement(CONFLICT_NODE);
 
-        conflict.setAttribute("their", QString::fromStdString(entry.their_id));
-        conflict.setAttribute("our", QString::fromStdString(entry.our_id));
-        conflict.setAttribute("ancestor", QString::fromStdString(entry.ancestor_id));
-        conflict.setAttribute("blob", QString::fromStdString(blob));
+        conflict.setAttribute("their", oid_to_attribute(entry.their_id));
+        conflict.setAttribute("our", oid_to_attribute(entry.our_id));
+        conflict.setAttribute("ancestor", oid_to_attribute(entry.ancestor_id));
+        conflict.setAttribute("blob", oid_to_attribute(blob));
 
         conflicts.appendChild(conflict);
     }
@@ -197,8 +217,8 @@ void save_conflicts(QDomElement& root, QDomDocument& doc) {
 
         const auto* tree_id = git_tree_id(tree.get());
 
-        commits.setAttribute("parent_tree", QString::fromStdString(conflict.parent_tree_id));
-        commits.setAttribute("commit", QString::fromStdString(conflict.commit_id));
+        commits.setAttribute("parent_tree", oid_to_attribute(conflict.parent_tree_id));
+        commits.setAttribute("commit", oid_to_attribute(conflict.commit_id));
         commits.setAttribute("tree", QString::fromStdString(git::format_oid_to_str<git::OID_SIZE>(tree_id)));
 
         conflict_commits.appendChild(commits);
@@ -220,11 +240,16 @@ void load_conflicts(QDomElement& root, SaveData& save_data, git_repository* repo
         QDomElement conflict = node.toElement();
 
         conflict::ConflictEntry entry;
-        entry.their_id    = conflict.attribute("their").toStdString();
-        entry.our_id      = conflict.attribute("our").toStdString();
-        entry.ancestor_id = conflict.attribute("ancestor").toStdString();
+        git_oid blob;
 
-        std::string blob = conflict.attribute("blob").toStdString();
+        bool valid = attribute_to_oid(conflict, "their", entry.their_id);
+        valid &= attribute_to_oid(conflict, "our", entry.our_id);
+        valid &= attribute_to_oid(conflict, "ancestor", entry.ancestor_id);
+        valid &= attribute_to_oid(conflict, "blob", blob);
+
+        if (!valid) {
+            continue;
+        }
 
         save_data.conflicts.emplace_back(entry, blob);
     }
@@ -240,8 +265,10 @@ void load_conflicts(QDomElement& root, SaveData& save_data, git_repository* repo
         QDomElement commits = node.toElement();
 
         conflict::ConflictTrees entry;
-        entry.parent_tree_id = commits.attribute("parent_tree").toStdString();
-        entry.commit_id      = commits.attribute("commit").toStdString();
+        if (!attribute_to_oid(commits, "parent_tree", entry.parent_tree_id)
+            || !attribute_to_oid(commits, "commit", entry.commit_id)) {
+            continue;
+        }
 
         auto tree_id = commits.attribute("tree").toStdString();
 